@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 
 #include <windows.h>
+#include <shlobj.h>
 
 #ifdef _WIN64
 #define REGKEY_SOFTWARE(path) L"SOFTWARE\\WOW6432NODE\\" path
@@ -81,6 +82,39 @@ namespace papyrus {
       return path;
     }
 
+    std::wstring logPath(Game game) {
+      const wchar_t* gameFolder = nullptr;
+      switch (game) {
+        case Game::Skyrim: {
+          gameFolder = L"Skyrim";
+          break;
+        }
+
+        case Game::SkyrimSE: {
+          gameFolder = L"Skyrim Special Edition";
+          break;
+        }
+
+        case Game::Fallout4: {
+          gameFolder = L"Fallout4";
+          break;
+        }
+
+        default: {
+          throw std::invalid_argument("Should not get here -- unrecognized game");
+        }
+      }
+
+      // Logs are kept under "My Games" in user's documents folder.
+      std::wstring path;
+      PWSTR documentsPath = nullptr;
+      if (SUCCEEDED(::SHGetKnownFolderPath(FOLDERID_Documents, 0, nullptr, &documentsPath))) {
+        path = std::wstring(documentsPath) + L"\\My Games\\" + gameFolder + L"\\Logs\\Script\\Papyrus.0.log";
+      }
+      ::CoTaskMemFree(documentsPath);
+      return path;
+    }
+
   } // namespace game
 
 } // namespace papyrus
@@ -57,6 +57,9 @@ namespace papyrus {
 
     std::wstring installationPath(Game game);
 
+    // Path of the game's Papyrus log, which is only written when Papyrus logging is enabled in game's ini
+    std::wstring logPath(Game game);
+
   } // namespace game
 
 } // namespace papyrus
@@ -0,0 +1,80 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utility {
+
+  // 64-bit FNV-1a hash. It is not cryptographically strong, but is fast and good enough to detect content changes.
+  using hash_t = std::uint64_t;
+
+  constexpr hash_t HASH_OFFSET_BASIS = 0xCBF29CE484222325;
+  constexpr hash_t HASH_PRIME        = 0x00000100000001B3;
+
+  inline hash_t hash(const void* data, size_t size, hash_t seed = HASH_OFFSET_BASIS) noexcept {
+    hash_t value = seed;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      value ^= bytes[i];
+      value *= HASH_PRIME;
+    }
+    return value;
+  }
+
+  inline hash_t hash(std::string_view str, hash_t seed = HASH_OFFSET_BASIS) noexcept { return hash(str.data(), str.size(), seed); }
+  inline hash_t hash(std::wstring_view str, hash_t seed = HASH_OFFSET_BASIS) noexcept { return hash(str.data(), str.size() * sizeof(wchar_t), seed); }
+
+  // Mix a value into an existing hash, so hashes of multiple parts can be chained together
+  inline hash_t hashCombine(hash_t seed, hash_t value) noexcept { return hash(&value, sizeof(value), seed); }
+
+  inline std::wstring hashToStr(hash_t value) { return std::format(L"{:016X}", value); }
+
+  inline hash_t strToHash(const std::wstring& str) noexcept {
+    hash_t value {};
+    try {
+      value = std::stoull(str, nullptr, 16);
+    } catch (...) {
+      // Invalid value is treated as an unknown hash
+    }
+    return value;
+  }
+
+  // Read the whole file and calculate its hash. Returns false if file cannot be read.
+  inline bool hashFile(const std::wstring& filePath, hash_t& value) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (file.fail()) {
+      return false;
+    }
+
+    value = HASH_OFFSET_BASIS;
+    std::vector<char> buffer(64 * 1024);
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+      value = hash(buffer.data(), static_cast<size_t>(file.gcount()), value);
+    }
+    return true;
+  }
+
+} // namespace
@@ -0,0 +1,78 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MemoryMappedFile.hpp"
+
+namespace utility {
+
+  namespace {
+    std::wstring getLastErrorMessage(const wchar_t* operation, const std::wstring& filePath) {
+      return std::wstring(operation) + L" failed on " + filePath + L". Error code: " + std::to_wstring(::GetLastError());
+    }
+  }
+
+  bool MemoryMappedFile::open(const std::wstring& filePath, bool writable, std::wstring& errorMsg) {
+    close();
+
+    fileHandle = ::CreateFile(filePath.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+      errorMsg = getLastErrorMessage(L"Opening file", filePath);
+      return false;
+    }
+
+    LARGE_INTEGER size {};
+    if (!::GetFileSizeEx(fileHandle, &size)) {
+      errorMsg = getLastErrorMessage(L"Getting file size", filePath);
+      close();
+      return false;
+    }
+
+    // An empty file cannot be mapped, but is still a valid (empty) file.
+    fileSize = static_cast<size_t>(size.QuadPart);
+    if (fileSize > 0) {
+      mappingHandle = ::CreateFileMapping(fileHandle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+      if (mappingHandle) {
+        view = ::MapViewOfFile(mappingHandle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+      }
+      if (!view) {
+        errorMsg = getLastErrorMessage(L"Mapping file", filePath);
+        close();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void MemoryMappedFile::close() noexcept {
+    if (view) {
+      ::UnmapViewOfFile(view);
+      view = nullptr;
+    }
+    if (mappingHandle) {
+      ::CloseHandle(mappingHandle);
+      mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+      ::CloseHandle(fileHandle);
+      fileHandle = INVALID_HANDLE_VALUE;
+    }
+    fileSize = 0;
+  }
+
+} // namespace
@@ -0,0 +1,57 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <windows.h>
+
+namespace utility {
+
+  // Maps a whole file into memory, so it can be read, or patched in place, without copying its content.
+  class MemoryMappedFile {
+    public:
+      MemoryMappedFile() = default;
+
+      // Disable all copy/move constructors/assignment operators
+      MemoryMappedFile(MemoryMappedFile&& other) = delete;
+
+      inline ~MemoryMappedFile() { close(); }
+
+      // Map the file. On failure, error message is returned in errorMsg
+      bool open(const std::wstring& filePath, bool writable, std::wstring& errorMsg);
+
+      // Unmap the file. Changes made to a writable mapping are written back to the file
+      void close() noexcept;
+
+      inline bool isOpen() const noexcept { return fileHandle != INVALID_HANDLE_VALUE; }
+      inline size_t size() const noexcept { return fileSize; }
+      inline unsigned char* data() const noexcept { return static_cast<unsigned char*>(view); }
+      inline std::string_view content() const noexcept { return std::string_view(static_cast<const char*>(view), fileSize); }
+
+    private:
+      HANDLE fileHandle {INVALID_HANDLE_VALUE};
+      HANDLE mappingHandle {};
+      void* view {};
+      size_t fileSize {0};
+  };
+
+} // namespace
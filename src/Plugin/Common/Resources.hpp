@@ -41,9 +41,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PPM_COMPILER_NOT_FOUND    (WM_USER + 3)
 #define PPM_OTHER_ERROR           (WM_USER + 4)
 #define PPM_JUMP_TO_ERROR         (WM_USER + 5)
+#define PPM_START_QUEUED_COMPILATION  (WM_USER + 6)
+#define PPM_COMPILATION_CANCELLED (WM_USER + 7)
+#define PPM_COMPILE_SAVED_FILES   (WM_USER + 8)
+#define PPM_COMPILATION_TIMED_OUT (WM_USER + 9) // Timeout in seconds is passed in wParam
+#define PPM_PROJECT_BUILD_DONE    (WM_USER + 10) // Pointer to Compiler::ProjectBuildSummary is passed in wParam
+#define PPM_DEPLOYMENT_FAILED     (WM_USER + 11) // Pointer to error message is passed in wParam
+#define PPM_CHECK_SYNTAX          (WM_USER + 12) // Buffer ID is passed in wParam, Scintilla handle of the view showing it in lParam
+#define PPM_SYNTAX_CHECK_DONE     (WM_USER + 13) // Pointer to Compiler::SyntaxCheckResult is passed in wParam
+#define PPM_RUNTIME_ERRORS        (WM_USER + 14) // Pointer to a new list of runtime errors is passed in wParam, owned by handler. lParam is true if restored from last session
 
 #define PARAM_COMPILATION_ONLY                0
 #define PARAM_COMPILATION_WITH_ANONYMIZATION  1
+#define PARAM_INCREMENTAL_BUILD               2 // Flag combined with the above. Number of compiled scripts is passed in lParam
+#define PARAM_DEPLOYED                        4 // Flag combined with the above, set when changed outputs are copied to deploy directories
+#define PARAM_SKIPPED_SHIFT                   8  // Number of scripts skipped as only comments or whitespace changed is passed in bits 8-15
+#define PARAM_SKIPPED_MASK                    0xFF
+#define PARAM_RESTORED_FROM_CACHE_SHIFT       16 // Number of scripts restored from compiled output cache is passed in bits 16-31
+#define PARAM_RESTORED_FROM_CACHE_MASK        0xFFFF
 
 //
 // Resources
@@ -52,6 +67,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Errors window resources
 #define IDD_ERRORS_WINDOW                                 16000 // Base #
 #define IDC_ERRORS_LIST                                   (IDD_ERRORS_WINDOW + 1)
+#define IDC_ERRORS_FILE_FILTER                            (IDD_ERRORS_WINDOW + 2)
+#define IDC_ERRORS_TEXT_FILTER                            (IDD_ERRORS_WINDOW + 3)
+
+// PEX inspector window resources
+#define IDD_PEX_INSPECTOR_WINDOW                          16100 // Base + 100
+#define IDC_PEX_INSPECTOR_TEXT                            (IDD_PEX_INSPECTOR_WINDOW + 1)
 
 
 // About dialog resources
@@ -158,6 +179,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define IDC_SETTINGS_COMPILER_RADIO_FO4                   (IDC_SETTINGS_COMPILER_GAMES_GROUP + 4)
 #define IDS_SETTINGS_COMPILER_RADIO_AUTO_TOOLTIP          (IDC_SETTINGS_COMPILER_GAMES_GROUP + 5)
 #define IDC_SETTINGS_COMPILER_ALLOW_UNMANAGED_SOURCE      (IDC_SETTINGS_COMPILER_GAMES_GROUP + 10)
+#define IDC_SETTINGS_COMPILER_COMPILE_ON_SAVE             (IDC_SETTINGS_COMPILER_GAMES_GROUP + 11)
+#define IDC_SETTINGS_COMPILER_OUTPUT_CACHE_SIZE_LABEL     (IDC_SETTINGS_COMPILER_GAMES_GROUP + 12)
+#define IDC_SETTINGS_COMPILER_OUTPUT_CACHE_SIZE           (IDC_SETTINGS_COMPILER_GAMES_GROUP + 13)
+#define IDC_SETTINGS_COMPILER_SKIP_TRIVIAL_CHANGES        (IDC_SETTINGS_COMPILER_GAMES_GROUP + 14)
+#define IDC_SETTINGS_COMPILER_CHECK_SYNTAX_IN_BACKGROUND  (IDC_SETTINGS_COMPILER_GAMES_GROUP + 15)
+#define IDC_SETTINGS_COMPILER_MONITOR_RUNTIME_LOG         (IDC_SETTINGS_COMPILER_GAMES_GROUP + 16)
 #define IDC_SETTINGS_COMPILER_AUTO_DEFAULT_GAME_LABEL     (IDC_SETTINGS_COMPILER_GAMES_GROUP + 30)
 #define IDC_SETTINGS_COMPILER_AUTO_DEFAULT_GAME_DROPDOWN  (IDC_SETTINGS_COMPILER_GAMES_GROUP + 31)
 #define IDC_SETTINGS_COMPILER_AUTO_DEFAULT_OUTPUT_LABEL   (IDC_SETTINGS_COMPILER_GAMES_GROUP + 32)
@@ -186,3 +213,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define IDC_SETTINGS_TAB_GAME_OPTIMIZE                    (IDC_SETTINGS_TAB_GAME + 14)
 #define IDC_SETTINGS_TAB_GAME_RELEASE                     (IDC_SETTINGS_TAB_GAME + 15)
 #define IDC_SETTINGS_TAB_GAME_FINAL                       (IDC_SETTINGS_TAB_GAME + 16)
+#define IDC_SETTINGS_TAB_GAME_COMPILATION_TIMEOUT_LABEL   (IDC_SETTINGS_TAB_GAME + 17)
+#define IDC_SETTINGS_TAB_GAME_COMPILATION_TIMEOUT         (IDC_SETTINGS_TAB_GAME + 18)
+#define IDC_SETTINGS_TAB_GAME_DEPLOY_DIRECTORIES_LABEL    (IDC_SETTINGS_TAB_GAME + 19)
+#define IDC_SETTINGS_TAB_GAME_DEPLOY_DIRECTORIES          (IDC_SETTINGS_TAB_GAME + 20)
@@ -108,11 +108,11 @@ namespace utility {
     size_t prevPos = 0;
     size_t pos = 0;
     while ((pos = indexOf(str, delimiter, prevPos, ignoreCase)) != std::string::npos) {
-      result.push_back(str.substr(prevPos, pos));
+      result.push_back(str.substr(prevPos, pos - prevPos));
       pos += delimiter.size();
       prevPos = pos;
     }
-    result.push_back(str.substr(prevPos, pos));
+    result.push_back(str.substr(prevPos));
 
     return result;
   }
@@ -122,11 +122,11 @@ namespace utility {
     size_t prevPos = 0;
     size_t pos = 0;
     while ((pos = indexOf(str, delimiter, prevPos, ignoreCase)) != std::string::npos) {
-      result.push_back(str.substr(prevPos, pos));
+      result.push_back(str.substr(prevPos, pos - prevPos));
       pos += delimiter.size();
       prevPos = pos;
     }
-    result.push_back(str.substr(prevPos, pos));
+    result.push_back(str.substr(prevPos));
 
     return result;
   }
@@ -0,0 +1,150 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TextDecoder.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace utility {
+
+  void TextDecoder::decode(std::string_view bytes, std::wstring& output) {
+    // Only a few bytes of an incomplete character could be pending.
+    std::string joinedBytes;
+    if (!pendingBytes.empty()) {
+      joinedBytes = pendingBytes;
+      joinedBytes.append(bytes);
+      pendingBytes.clear();
+      bytes = joinedBytes;
+    }
+
+    // ASCII chars are the same in all supported code pages, and are simply widened.
+    size_t asciiLength = asciiPrefixLength(bytes);
+    output.append(bytes.begin(), bytes.begin() + asciiLength);
+    bytes.remove_prefix(asciiLength);
+    if (bytes.empty()) {
+      return;
+    }
+
+    if (codePage == 0) {
+      UINT consoleCodePage = ::GetConsoleOutputCP();
+      codePage = isValidUtf8(bytes) ? CP_UTF8 : (consoleCodePage != 0 ? consoleCodePage : ::GetOEMCP());
+    }
+
+    size_t length = completeLength(bytes);
+    convert(bytes.substr(0, length), output);
+    pendingBytes.assign(bytes.substr(length));
+  }
+
+  void TextDecoder::finish(std::wstring& output) {
+    if (!pendingBytes.empty()) {
+      convert(pendingBytes, output); // Incomplete character is decoded as replacement char
+      pendingBytes.clear();
+    }
+  }
+
+  // Private methods
+  //
+
+  size_t TextDecoder::asciiPrefixLength(std::string_view bytes) noexcept {
+    constexpr std::uint64_t NON_ASCII_MASK = 0x8080808080808080;
+
+    size_t length = 0;
+    for (; length + sizeof(std::uint64_t) <= bytes.size(); length += sizeof(std::uint64_t)) {
+      std::uint64_t word;
+      std::memcpy(&word, bytes.data() + length, sizeof(word));
+      if (word & NON_ASCII_MASK) {
+        break;
+      }
+    }
+    while (length < bytes.size() && static_cast<unsigned char>(bytes[length]) < 0x80) {
+      ++length;
+    }
+    return length;
+  }
+
+  bool TextDecoder::isValidUtf8(std::string_view bytes) noexcept {
+    for (size_t i = 0; i < bytes.size();) {
+      unsigned char ch = static_cast<unsigned char>(bytes[i]);
+      size_t sequenceLength =
+        ch < 0x80 ? 1 :
+        ch < 0xC2 ? 0 : // Continuation byte or overlong lead byte
+        ch < 0xE0 ? 2 :
+        ch < 0xF0 ? 3 :
+        ch < 0xF5 ? 4 :
+        0;
+      if (sequenceLength == 0) {
+        return false;
+      }
+
+      for (size_t j = 1; j < sequenceLength && i + j < bytes.size(); ++j) {
+        if ((static_cast<unsigned char>(bytes[i + j]) & 0xC0) != 0x80) {
+          return false;
+        }
+      }
+      i += sequenceLength;
+    }
+    return true;
+  }
+
+  size_t TextDecoder::completeLength(std::string_view bytes) const noexcept {
+    if (codePage == CP_UTF8) {
+      // Look back for the lead byte of last character.
+      for (size_t i = 1; i <= std::min<size_t>(4, bytes.size()); ++i) {
+        unsigned char ch = static_cast<unsigned char>(bytes[bytes.size() - i]);
+        if ((ch & 0xC0) != 0x80) {
+          size_t sequenceLength = (ch >= 0xF0 ? 4 : ch >= 0xE0 ? 3 : ch >= 0xC0 ? 2 : 1);
+          return (sequenceLength > i ? bytes.size() - i : bytes.size());
+        }
+      }
+      return bytes.size();
+    }
+
+    CPINFO codePageInfo {};
+    if (!::GetCPInfo(codePage, &codePageInfo) || codePageInfo.MaxCharSize < 2) {
+      return bytes.size(); // Single byte code page
+    }
+
+    // Double byte code page. Lead bytes can only be found by walking from a known character boundary.
+    size_t length = 0;
+    while (length < bytes.size()) {
+      size_t charLength = ::IsDBCSLeadByteEx(codePage, static_cast<BYTE>(bytes[length])) ? 2 : 1;
+      if (length + charLength > bytes.size()) {
+        break;
+      }
+      length += charLength;
+    }
+    return length;
+  }
+
+  void TextDecoder::convert(std::string_view bytes, std::wstring& output) const {
+    if (bytes.empty()) {
+      return;
+    }
+
+    int length = ::MultiByteToWideChar(codePage, 0, bytes.data(), static_cast<int>(bytes.size()), nullptr, 0);
+    if (length > 0) {
+      size_t offset = output.size();
+      output.resize(offset + length);
+      ::MultiByteToWideChar(codePage, 0, bytes.data(), static_cast<int>(bytes.size()), &output[offset], length);
+    }
+  }
+
+} // namespace
@@ -0,0 +1,60 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <windows.h>
+
+namespace utility {
+
+  // Decodes bytes written by a console program, e.g. PapyrusCompiler, into wide chars. Bytes can be fed in chunks as they
+  // arrive, with multibyte characters split between chunks handled properly. Output is treated as UTF-8 if the first
+  // non-ASCII bytes are valid UTF-8, otherwise console output code page (OEM code page by default) is used.
+  class TextDecoder {
+    public:
+      // Decode a chunk of bytes and append decoded text to output. Incomplete character at the end is kept for next chunk
+      void decode(std::string_view bytes, std::wstring& output);
+
+      // Decode any pending bytes left by the last chunk
+      void finish(std::wstring& output);
+
+      inline UINT getCodePage() const noexcept { return codePage; }
+
+    private:
+      // Length of the prefix that only contains ASCII chars, checked a machine word at a time
+      static size_t asciiPrefixLength(std::string_view bytes) noexcept;
+
+      // Check if bytes are valid UTF-8, allowing an incomplete sequence at the end
+      static bool isValidUtf8(std::string_view bytes) noexcept;
+
+      // Length of the prefix that only contains complete characters in current code page
+      size_t completeLength(std::string_view bytes) const noexcept;
+
+      void convert(std::string_view bytes, std::wstring& output) const;
+
+      // Private members
+      //
+      UINT codePage {0}; // Not determined until non-ASCII chars are seen
+      std::string pendingBytes;
+  };
+
+} // namespace
@@ -0,0 +1,162 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CompilerErrorParser.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <unordered_set>
+
+namespace papyrus {
+
+  namespace {
+    // Identity of a parsed error, referring to compiler output directly
+    struct ErrorKey {
+      std::wstring_view file;
+      std::wstring_view message;
+      int line {0};
+      int column {0};
+
+      bool operator==(const ErrorKey&) const noexcept = default;
+    };
+
+    struct ErrorKeyHash {
+      size_t operator()(const ErrorKey& key) const noexcept {
+        std::hash<std::wstring_view> hashView;
+        size_t value = hashView(key.file);
+        value = value * 31 + hashView(key.message);
+        value = value * 31 + static_cast<size_t>(key.line);
+        return value * 31 + static_cast<size_t>(key.column);
+      }
+    };
+  }
+
+  bool CompilerErrorParser::parse(std::wstring_view errorText, bool parseAssemblyErrors, const std::wstring& outputDirectory, std::vector<Error>& errors) {
+    bool hasUnparsableLines = false;
+    size_t previousErrorCount = errors.size();
+    std::unordered_set<ErrorKey, ErrorKeyHash> parsedErrors;
+    for (size_t lineStart = 0; lineStart < errorText.size();) {
+      size_t lineEnd = errorText.find(L'\n', lineStart);
+      if (lineEnd == std::wstring_view::npos) {
+        lineEnd = errorText.size();
+      }
+      std::wstring_view lineError = errorText.substr(lineStart, lineEnd - lineStart);
+      lineStart = lineEnd + 1;
+      if (!lineError.empty() && lineError.back() == L'\r') {
+        lineError.remove_suffix(1);
+      }
+
+      // Error format: "<file>.psc(<line>,<column>): <message>", "<unknown>(<line>,<column>): <message>", or "<file>.pas(<line>): <message>"
+      std::wstring_view file;
+      bool isScriptError = false;
+      if (lineError.starts_with(L"<unknown>")) {
+        file = lineError.substr(0, 9);
+        lineError.remove_prefix(std::min<size_t>(10, lineError.size()));
+      } else {
+        size_t fileExtIndex = lineError.find(L".psc(");
+        if (fileExtIndex == std::wstring_view::npos && parseAssemblyErrors) {
+          fileExtIndex = lineError.find(L".pas(");
+          isScriptError = true;
+        }
+
+        if (fileExtIndex != std::wstring_view::npos) {
+          file = lineError.substr(0, fileExtIndex + 4);
+          lineError.remove_prefix(fileExtIndex + 5);
+        }
+      }
+
+      if (file.empty()) {
+        continue;
+      }
+
+      ErrorKey key { .file = file };
+      size_t indexParenthesis = lineError.find(L')');
+      bool parsed = false;
+      if (indexParenthesis != std::wstring_view::npos) {
+        if (!isScriptError) { // .psc, column can be left out
+          size_t indexComma = lineError.find(L',');
+          if (indexComma < indexParenthesis) {
+            parsed = parseNumber(lineError.substr(0, indexComma), key.line)
+              && parseNumber(lineError.substr(indexComma + 1, indexParenthesis - indexComma - 1), key.column);
+          } else {
+            parsed = parseNumber(lineError.substr(0, indexParenthesis), key.line);
+          }
+          key.message = lineError.substr(std::min(indexParenthesis + 3, lineError.size()));
+        } else { // .pas
+          parsed = parseNumber(lineError.substr(0, indexParenthesis), key.line);
+          key.column = 1; // Papyrus compiler doesn't provide column info for .pas files
+          key.message = lineError.substr(std::min(indexParenthesis + 4, lineError.size()));
+        }
+      }
+
+      if (!parsed) {
+        hasUnparsableLines = true;
+      } else if (parsedErrors.insert(key).second) { // Discard duplicate errors
+        errors.push_back(Error {
+          .file = isScriptError ? (std::filesystem::path(outputDirectory) / key.file).wstring() : std::wstring(key.file), // Papyrus compiler doesn't provide full path for .pas files
+          .message = std::wstring(key.message),
+          .line = key.line,
+          .column = key.column
+        });
+      }
+    }
+
+    if (errors.size() == previousErrorCount) {
+      // In the rare case when error cannot be parsed (likely some errors dumped on stdout that are not related to specific files), send the whole output to error window.
+      errors.push_back(Error {
+        .message = std::wstring(errorText)
+      });
+    }
+    return hasUnparsableLines;
+  }
+
+  // Private methods
+  //
+
+  bool CompilerErrorParser::parseNumber(std::wstring_view text, int& number) noexcept {
+    size_t start = text.find_first_not_of(L' ');
+    size_t end = text.find_last_not_of(L' ');
+    if (start == std::wstring_view::npos) {
+      return false;
+    }
+    text = text.substr(start, end - start + 1);
+
+    bool isNegative = text.starts_with(L'-');
+    if (isNegative) {
+      text.remove_prefix(1);
+    }
+    if (text.empty() || text.size() > 9) {
+      return false;
+    }
+
+    number = 0;
+    for (wchar_t ch : text) {
+      if (ch < L'0' || ch > L'9') {
+        return false;
+      }
+      number = number * 10 + (ch - L'0');
+    }
+    if (isNegative) {
+      number = -number;
+    }
+    return true;
+  }
+
+} // namespace
@@ -0,0 +1,43 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Error.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace papyrus {
+
+  // Parser of errors reported by Papyrus compiler, which doesn't depend on how compiler is run.
+  class CompilerErrorParser {
+    public:
+      // Parse compilation errors and append them to the given list, discarding duplicates. Errors of generated .pas files are only
+      // recognized if "parseAssemblyErrors" is true (optimize flag is set), and are put under output directory as compiler only
+      // reports their names. If no error can be parsed, the whole text is added as one error. Returns true if there are unparsable lines
+      static bool parse(std::wstring_view errorText, bool parseAssemblyErrors, const std::wstring& outputDirectory, std::vector<Error>& errors);
+
+    private:
+      // Parse a decimal number, allowing surrounding spaces
+      static bool parseNumber(std::wstring_view text, int& number) noexcept;
+  };
+
+} // namespace
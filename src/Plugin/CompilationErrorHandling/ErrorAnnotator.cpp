@@ -23,13 +23,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "..\Common\Logger.hpp"
 #include "..\Common\StringUtil.hpp"
+#include "..\Lexer\Tokenizer.hpp"
 
-#include "..\..\external\gsl\include\gsl\util"
 #include "..\..\external\npp\Common.h"
 
-#include <list>
-#include <map>
+#include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace papyrus {
 
@@ -74,42 +75,67 @@ namespace papyrus {
     }
   }
 
-  void ErrorAnnotator::annotate(const std::vector<Error>& compilationErrors) {
-    for (const auto& error : compilationErrors) {
-      std::wstring key = utility::toUpper(error.file);
-      if (!errors.contains(key)) {
-        errors[key] = FileErrors();
+  void ErrorAnnotator::annotate(const std::vector<std::wstring>& scopes, const std::vector<Error>& compilationErrors) {
+    std::unordered_map<std::wstring, FileErrors> newErrors;
+    addErrors(newErrors, compilationErrors);
+
+    // Scripts in compiled scopes that no longer have errors are diffed against nothing.
+    std::vector<std::wstring> fixedFiles;
+    for (const auto& [key, file] : errors) {
+      if (!newErrors.contains(key) && std::any_of(scopes.begin(), scopes.end(), [&](const auto& scope) {
+        std::wstring scopeKey = utility::toUpper(scope);
+        return key == scopeKey || utility::startsWith(key, scopeKey + L"\\");
+      })) {
+        fixedFiles.push_back(key);
       }
+    }
 
-      auto& errorList = errors[key];
-      auto iter = std::find_if(errorList.begin(), errorList.end(),
-        [&](const auto& lineError) {
-          // Scintilla's line # is zero-based.
-          return lineError.line == error.line - 1;
+    for (const auto& key : fixedFiles) {
+      replaceErrors(key, nullptr);
+    }
+    for (auto& [key, file] : newErrors) {
+      replaceErrors(key, &file);
+    }
+  }
+
+  void ErrorAnnotator::add(const std::vector<Error>& newErrors) {
+    std::unordered_map<std::wstring, FileErrors> newFiles;
+    addErrors(newFiles, newErrors);
+
+    for (auto& [key, file] : newFiles) {
+      // Lines that already have errors keep them, with new errors listed after.
+      auto existing = errors.find(key);
+      if (existing != errors.end()) {
+        existing->second.rebase();
+        for (const auto& [line, lineError] : existing->second.lineErrors) {
+          auto [merged, inserted] = file.lineErrors.try_emplace(line, lineError);
+          if (!inserted) {
+            merged->second.message = lineError.message + "\r\n" + merged->second.message;
+            merged->second.columns.insert(merged->second.columns.begin(), lineError.columns.begin(), lineError.columns.end());
+          }
         }
-      );
-      if (iter == errorList.end()) {
-        LineError lineError {
-          .line = error.line - 1, // Scintilla's line # is zero-based
-          .message = wstring2string(L"Error: " + error.message, SC_CP_UTF8), // Scintilla does not use wide char
-          .columns { error.column }
-        };
-        errorList.push_back(lineError);
-      } else {
-        iter->message += "\r\n" + wstring2string(L"Error: " + error.message, SC_CP_UTF8);
-        iter->columns.push_back(error.column);
+        file.anchors.clear();
+        for (const auto& [line, lineError] : file.lineErrors) {
+          file.anchors.push_back(line);
+        }
+        std::sort(file.anchors.begin(), file.anchors.end());
+        file.shifts.assign(file.anchors.size() + 1, 0);
       }
+      replaceErrors(key, &file);
     }
-
-    annotate(MAIN_VIEW);
-    annotate(SUB_VIEW);
   }
 
   void ErrorAnnotator::annotate(npp_view_t view, std::wstring filePath) {
     HWND handle = (view == MAIN_VIEW ? nppData._scintillaMainHandle : nppData._scintillaSecondHandle);
 
+    // Annotations are kept in the document, so whatever was drawn when it was shown last time is cleared first.
+    clearAnnotations(handle);
+    clearIndications(handle);
+    Viewport& fileViewport = viewport(handle);
+    fileViewport = Viewport { .fileKey = utility::toUpper(filePath) };
+
     // Check if current file has errors.
-    auto fileErrors = errors.find(utility::toUpper(filePath));
+    auto fileErrors = errors.find(fileViewport.fileKey);
     if (fileErrors != errors.end()) {
       // Update annotation style.
       updateAnnotationStyle(view, handle);
@@ -117,31 +143,260 @@ namespace papyrus {
       // Update indicator style.
       updateIndicatorStyle(handle);
 
-      for (const LineError& lineError : fileErrors->second) {
-        // Annotation
-        drawAnnotations(handle, lineError);
+      std::tie(fileViewport.firstLine, fileViewport.lastLine) = getViewportLines(handle);
+      materialize(handle, fileErrors->second, fileViewport.firstLine, fileViewport.lastLine);
+    }
+  }
+
+  bool ErrorAnnotator::hasErrors(const std::wstring& filePath) const {
+    return errors.contains(utility::toUpper(filePath));
+  }
+
+  void ErrorAnnotator::update(const std::wstring& filePath, const std::vector<Error>& fileErrors) {
+    annotate(std::vector<std::wstring> { filePath }, fileErrors);
+  }
+
+  void ErrorAnnotator::handleContentChange(HWND handle, int line, int linesAdded) {
+    if (errors.empty() || linesAdded == 0 || (handle != nppData._scintillaMainHandle && handle != nppData._scintillaSecondHandle)) {
+      return;
+    }
+
+    npp_view_t view = (handle == nppData._scintillaMainHandle ? MAIN_VIEW : SUB_VIEW);
+    auto fileErrors = errors.find(utility::toUpper(utility::getApplicableFilePathOnView(nppData._nppHandle, view)));
+    if (fileErrors == errors.end()) {
+      return;
+    }
+
+    FileErrors& file = fileErrors->second;
+    size_t first = file.upperBound(line);
+    if (linesAdded > 0) {
+      file.shift(first, linesAdded);
+    } else {
+      // Lines after the edited one up to (line - linesAdded) are gone, along with their errors.
+      size_t last = file.upperBound(line - linesAdded);
+      file.shift(last, linesAdded);
+      bool hasDeletedErrors = (first < last);
+      if (hasDeletedErrors) {
+        file.rebase(first, last);
+      }
+
+      // Scintilla moves annotation of a deleted line onto the line it is joined with, so that line is the only one to redraw.
+      if (first > 0 && file.line(first - 1) == line) {
+        drawAnnotations(handle, line, file.lineErrors.at(file.anchors[first - 1]));
+      } else if (hasDeletedErrors) {
+        ::SendMessage(handle, SCI_ANNOTATIONSETTEXT, line, 0);
+      }
+    }
 
-        // Indicator
-        drawIndications(handle, lineError);
+    // Drawn lines move along with the edit, so viewport follows them: inserting lines above it moves both bounds down, inserting lines
+    // in it moves its bottom, while deleting lines moves bounds up, but not above the edited line.
+    Viewport& fileViewport = viewport(handle);
+    if (fileViewport.fileKey == fileErrors->first && line < fileViewport.lastLine) {
+      int lineCount = fileViewport.lastLine - fileViewport.firstLine;
+      if (line < fileViewport.firstLine) {
+        fileViewport.firstLine = std::max(line + 1, fileViewport.firstLine + linesAdded);
       }
+      fileViewport.lastLine = std::max(line, fileViewport.lastLine + linesAdded);
+
+      // Deleted lines pull lines that were not drawn up across viewport's bottom, which are drawn to keep its size.
+      if (fileViewport.lastLine - fileViewport.firstLine < lineCount) {
+        int lastLine = fileViewport.firstLine + lineCount;
+        materialize(handle, file, fileViewport.lastLine + 1, lastLine);
+        fileViewport.lastLine = lastLine;
+      }
+    }
+  }
+
+  void ErrorAnnotator::handleScroll(HWND handle) {
+    if (errors.empty() || (handle != nppData._scintillaMainHandle && handle != nppData._scintillaSecondHandle)) {
+      return;
+    }
+
+    // Make sure the view still shows the file it was annotated for.
+    Viewport& fileViewport = viewport(handle);
+    auto fileErrors = errors.find(fileViewport.fileKey);
+    npp_view_t view = (handle == nppData._scintillaMainHandle ? MAIN_VIEW : SUB_VIEW);
+    if (fileErrors == errors.end() || utility::toUpper(utility::getApplicableFilePathOnView(nppData._nppHandle, view)) != fileViewport.fileKey) {
+      return;
+    }
+
+    auto [firstLine, lastLine] = getViewportLines(handle);
+    if (firstLine == fileViewport.firstLine && lastLine == fileViewport.lastLine) {
+      return;
+    }
+
+    // Release lines no longer near the viewport, then draw newly reached ones.
+    const FileErrors& file = fileErrors->second;
+    if (firstLine > fileViewport.lastLine || lastLine < fileViewport.firstLine) {
+      release(handle, file, fileViewport.firstLine, fileViewport.lastLine);
+      materialize(handle, file, firstLine, lastLine);
     } else {
-      clearAnnotations(handle);
-      clearIndications(handle);
+      if (fileViewport.firstLine < firstLine) {
+        release(handle, file, fileViewport.firstLine, firstLine - 1);
+      }
+      if (fileViewport.lastLine > lastLine) {
+        release(handle, file, lastLine + 1, fileViewport.lastLine);
+      }
+      if (firstLine < fileViewport.firstLine) {
+        materialize(handle, file, firstLine, fileViewport.firstLine - 1);
+      }
+      if (lastLine > fileViewport.lastLine) {
+        materialize(handle, file, fileViewport.lastLine + 1, lastLine);
+      }
     }
+    fileViewport.firstLine = firstLine;
+    fileViewport.lastLine = lastLine;
   }
 
   // Private methods
   //
 
-  void ErrorAnnotator::annotate(npp_view_t view) {
-    // Annotate current file on the given view if it's Papyrus script.
-    std::wstring filePath = utility::getApplicableFilePathOnView(nppData._nppHandle, view);
-    if (!filePath.empty()) {
-      annotate(view, filePath);
-    } else {
+  int ErrorAnnotator::FileErrors::line(size_t index) const noexcept {
+    int line = anchors[index];
+    for (size_t i = index + 1; i > 0; i -= (i & (0 - i))) {
+      line += shifts[i];
+    }
+    return line;
+  }
+
+  size_t ErrorAnnotator::FileErrors::upperBound(int line) const noexcept {
+    // Current lines stay in ascending order, as errors on deleted lines are dropped.
+    size_t low = 0;
+    size_t high = anchors.size();
+    while (low < high) {
+      size_t middle = low + (high - low) / 2;
+      if (this->line(middle) > line) {
+        high = middle;
+      } else {
+        low = middle + 1;
+      }
+    }
+    return low;
+  }
+
+  void ErrorAnnotator::FileErrors::shift(size_t index, int linesAdded) noexcept {
+    for (size_t i = index + 1; i < shifts.size(); i += (i & (0 - i))) {
+      shifts[i] += linesAdded;
+    }
+  }
+
+  void ErrorAnnotator::FileErrors::rebase(size_t first, size_t last) {
+    std::unordered_map<int, LineError> rebasedLineErrors;
+    std::vector<int> rebasedAnchors;
+    for (size_t i = 0; i < anchors.size(); ++i) {
+      if (i < first || i >= last) {
+        int current = line(i);
+        rebasedLineErrors.emplace(current, std::move(lineErrors[anchors[i]]));
+        rebasedAnchors.push_back(current);
+      }
+    }
+    lineErrors.swap(rebasedLineErrors);
+    anchors.swap(rebasedAnchors);
+    shifts.assign(anchors.size() + 1, 0);
+  }
+
+  void ErrorAnnotator::addErrors(std::unordered_map<std::wstring, FileErrors>& fileErrorsMap, const std::vector<Error>& compilationErrors) {
+    // Errors come grouped by file, so the file looked up last is usually the one needed.
+    std::unordered_map<std::wstring, FileErrors*> fileLookup;
+    const std::wstring* lastFile = nullptr;
+    FileErrors* fileErrors = nullptr;
+    std::vector<LineError*> updatedLines;
+    for (const auto& error : compilationErrors) {
+      if (!lastFile || *lastFile != error.file) {
+        auto& cached = fileLookup[error.file];
+        if (!cached) {
+          cached = &fileErrorsMap[utility::toUpper(error.file)];
+        }
+        fileErrors = cached;
+        lastFile = &error.file;
+      }
+
+      int line = error.line - 1; // Scintilla's line # is zero-based
+      auto [iter, inserted] = fileErrors->lineErrors.try_emplace(line);
+      LineError& lineError = iter->second;
+      if (inserted) {
+        updatedLines.push_back(&lineError);
+      } else {
+        lineError.text += L"\r\n";
+      }
+      lineError.text += L"Error: " + error.message;
+      lineError.columns.push_back(error.column);
+    }
+
+    for (LineError* lineError : updatedLines) {
+      lineError->message = wstring2string(lineError->text, SC_CP_UTF8); // Scintilla does not use wide char
+      lineError->text.clear();
+      lineError->text.shrink_to_fit();
+    }
+
+    for (auto& [filePath, file] : fileLookup) {
+      file->anchors.clear();
+      for (const auto& [line, lineError] : file->lineErrors) {
+        file->anchors.push_back(line);
+      }
+      std::sort(file->anchors.begin(), file->anchors.end());
+      file->shifts.assign(file->anchors.size() + 1, 0);
+    }
+  }
+
+  void ErrorAnnotator::replaceErrors(const std::wstring& key, FileErrors* newFile) {
+    // Both sides are keyed by current lines after rebase, so line errors can be matched directly.
+    FileErrors previous;
+    auto existing = errors.find(key);
+    if (existing != errors.end()) {
+      existing->second.rebase();
+      previous = std::move(existing->second);
+    }
+
+    const FileErrors* current = nullptr;
+    if (newFile) {
+      FileErrors& stored = errors[key];
+      stored = std::move(*newFile);
+      current = &stored;
+    } else if (existing != errors.end()) {
+      errors.erase(existing);
+    }
+
+    for (npp_view_t view : { MAIN_VIEW, SUB_VIEW }) {
+      std::wstring filePath = utility::getApplicableFilePathOnView(nppData._nppHandle, view);
+      if (filePath.empty() || utility::toUpper(filePath) != key) {
+        continue;
+      }
+
       HWND handle = (view == MAIN_VIEW ? nppData._scintillaMainHandle : nppData._scintillaSecondHandle);
-      clearAnnotations(handle);
-      clearIndications(handle);
+      const Viewport& fileViewport = viewport(handle);
+      if (fileViewport.fileKey != key) {
+        annotate(view, filePath);
+        continue;
+      }
+
+      // Within what is drawn, lines whose errors are gone or changed are released first, then new or changed ones are drawn.
+      updateAnnotationStyle(view, handle);
+      updateIndicatorStyle(handle);
+      for (size_t i = previous.upperBound(fileViewport.firstLine - 1); i < previous.anchors.size() && previous.anchors[i] <= fileViewport.lastLine; ++i) {
+        int line = previous.anchors[i];
+        auto now = current ? current->lineErrors.find(line) : previous.lineErrors.end();
+        if (!current || now == current->lineErrors.end()) {
+          ::SendMessage(handle, SCI_ANNOTATIONSETTEXT, line, 0);
+        }
+        if (!current || now == current->lineErrors.end() || !(now->second == previous.lineErrors.at(line))) {
+          ::SendMessage(handle, SCI_SETINDICATORCURRENT, indicatorID, 0);
+          ::SendMessage(handle, SCI_INDICATORCLEARRANGE, ::SendMessage(handle, SCI_POSITIONFROMLINE, line, 0), ::SendMessage(handle, SCI_LINELENGTH, line, 0));
+        }
+      }
+
+      if (current) {
+        std::string_view document = getDocument(handle, fileViewport.lastLine);
+        for (size_t i = current->upperBound(fileViewport.firstLine - 1); i < current->anchors.size() && current->anchors[i] <= fileViewport.lastLine; ++i) {
+          int line = current->anchors[i];
+          const LineError& lineError = current->lineErrors.at(line);
+          auto before = previous.lineErrors.find(line);
+          if (before == previous.lineErrors.end() || !(before->second == lineError)) {
+            drawAnnotations(handle, line, lineError);
+            drawIndications(handle, document, line, lineError);
+          }
+        }
+      }
     }
   }
 
@@ -196,12 +451,12 @@ namespace papyrus {
     settings.enableAnnotation ? showAnnotations(handle) : hideAnnotations(handle);
   }
 
-  void ErrorAnnotator::drawAnnotations(HWND handle, const LineError& lineError) const {
-    ::SendMessage(handle, SCI_ANNOTATIONSETTEXT, lineError.line, reinterpret_cast<LPARAM>(lineError.message.c_str()));
-    ::SendMessage(handle, SCI_ANNOTATIONSETSTYLE, lineError.line, 0); // Use the first (and the only) style assigned to us
+  void ErrorAnnotator::drawAnnotations(HWND handle, int line, const LineError& lineError) const {
+    ::SendMessage(handle, SCI_ANNOTATIONSETTEXT, line, reinterpret_cast<LPARAM>(lineError.message.c_str()));
+    ::SendMessage(handle, SCI_ANNOTATIONSETSTYLE, line, 0); // Use the first (and the only) style assigned to us
   }
 
-  // Since indication locations are not tracked after they were draw, calling this method could cause newly rendered indications to be off.
+  // Indications are redrawn at current error lines, which follow edits, though columns within edited lines could be off.
   void ErrorAnnotator::changeIndicator() {
     int oldIndicatorID = indicatorID;
     if (settings.autoAllocateIndicatorID) {
@@ -264,68 +519,72 @@ namespace papyrus {
 
   void ErrorAnnotator::updateIndicatorStyleOnFile(HWND handle, const std::wstring& filePath) {
     // Check if current file has errors.
+    const Viewport& fileViewport = viewport(handle);
     auto fileErrors = errors.find(utility::toUpper(filePath));
-    if (fileErrors != errors.end()) {
+    if (fileErrors != errors.end() && fileViewport.fileKey == fileErrors->first) {
       updateIndicatorStyle(handle);
-      for (const LineError& lineError : fileErrors->second) {
-        drawIndications(handle, lineError);
+      const FileErrors& file = fileErrors->second;
+      std::string_view document = getDocument(handle, fileViewport.lastLine);
+      for (size_t i = file.upperBound(fileViewport.firstLine - 1); i < file.anchors.size() && file.line(i) <= fileViewport.lastLine; ++i) {
+        drawIndications(handle, document, file.line(i), file.lineErrors.at(file.anchors[i]));
       }
     }
   }
 
-  void ErrorAnnotator::drawIndications(HWND handle, const LineError& lineError) const {
-    // Get line start position and length.
-    npp_position_t lineStart = ::SendMessage(handle, SCI_POSITIONFROMLINE, lineError.line, 0);
-    npp_position_t lineLength = ::SendMessage(handle, SCI_LINELENGTH, lineError.line, 0);
+  std::string_view ErrorAnnotator::getDocument(HWND handle, int lastLine) const {
+    // Scintilla does not use wide char. Range pointer makes the requested part of the buffer contiguous, so it can be read without copying.
+    npp_position_t length = ::SendMessage(handle, SCI_GETLENGTH, 0, 0);
+    if (lastLine + 1 < ::SendMessage(handle, SCI_GETLINECOUNT, 0, 0)) {
+      length = ::SendMessage(handle, SCI_POSITIONFROMLINE, lastLine + 1, 0);
+    }
+    const char* content = reinterpret_cast<const char*>(::SendMessage(handle, SCI_GETRANGEPOINTER, 0, length));
+    return content ? std::string_view(content, static_cast<size_t>(length)) : std::string_view();
+  }
 
-    // Scintilla does not use wide char, also returned line length does not include the ending null char.
-    char* line = new char[lineLength + 1];
-    auto autoCleanup = gsl::finally([&] { delete[] line; });
-    npp_position_t filledLength = ::SendMessage(handle, SCI_GETLINE, lineError.line, reinterpret_cast<LPARAM>(line));
-    if (filledLength <= lineLength) {
-      line[filledLength] = 0;
+  std::pair<int, int> ErrorAnnotator::getViewportLines(HWND handle) const {
+    // First visible line and lines on screen count display lines, which differ from document lines when lines are wrapped, folded or annotated.
+    int firstVisibleLine = static_cast<int>(::SendMessage(handle, SCI_GETFIRSTVISIBLELINE, 0, 0));
+    int linesOnScreen = static_cast<int>(::SendMessage(handle, SCI_LINESONSCREEN, 0, 0));
+    int firstLine = static_cast<int>(::SendMessage(handle, SCI_DOCLINEFROMVISIBLE, std::max(firstVisibleLine - linesOnScreen, 0), 0));
+    int lastLine = static_cast<int>(::SendMessage(handle, SCI_DOCLINEFROMVISIBLE, firstVisibleLine + 2 * linesOnScreen, 0));
+    return std::make_pair(firstLine, lastLine);
+  }
+
+  void ErrorAnnotator::materialize(HWND handle, const FileErrors& file, int firstLine, int lastLine) const {
+    std::string_view document = getDocument(handle, lastLine);
+    for (size_t i = file.upperBound(firstLine - 1); i < file.anchors.size(); ++i) {
+      int line = file.line(i);
+      if (line > lastLine) {
+        break;
+      }
+
+      const LineError& lineError = file.lineErrors.at(file.anchors[i]);
+      drawAnnotations(handle, line, lineError);
+      drawIndications(handle, document, line, lineError);
     }
+  }
 
-    for (int column : lineError.columns) {
-      int length = 0;
-      int search = column;
-      if (search < filledLength) {
-        if (isalpha(line[search]) || line[search] == '_') {
-          // Papyrus keyword starts with alpha or underscore and can have numbers in it.
-          while (search < filledLength
-            && (isalnum(line[search]) || line[search] == '_' || line[search] == ':')
-          ) {
-            search++;
-            length++;
-          }
-        } else if (isdigit(line[search]) || line[search] == '-') {
-          // Numbers are digits or hex numbers starting with 0[xX]
-          bool isHex = (line[search] == '0' && filledLength - search > 1 && tolower(line[search + 1]) == 'x');
-          bool hasDigit = false;
-          while (search < filledLength
-            && (isdigit(line[search])
-              || (line[search] == '-' && search == column) // leading minus sign
-              || (line[search] == '.' && hasDigit) // decimal point after at least a digit
-              || (isHex && (isxdigit(line[search]) || (tolower(line[search]) == 'x' && search == column + 1)))
-            )
-          ) {
-            if (isdigit(line[search])) {
-              hasDigit = true;
-            }
-            search++;
-            length++;
-          }
-        } else if (!isspace(line[search])) {
-          while (search < filledLength && !isalnum(line[search]) && !isspace(line[search])) {
-            search++;
-            length++;
-          }
-        } else {
-          // Blank or line end
-          length = 1;
-        }
+  void ErrorAnnotator::release(HWND handle, const FileErrors& file, int firstLine, int lastLine) const {
+    ::SendMessage(handle, SCI_SETINDICATORCURRENT, indicatorID, 0);
+    for (size_t i = file.upperBound(firstLine - 1); i < file.anchors.size(); ++i) {
+      int line = file.line(i);
+      if (line > lastLine) {
+        break;
       }
 
+      ::SendMessage(handle, SCI_ANNOTATIONSETTEXT, line, 0);
+      ::SendMessage(handle, SCI_INDICATORCLEARRANGE, ::SendMessage(handle, SCI_POSITIONFROMLINE, line, 0), ::SendMessage(handle, SCI_LINELENGTH, line, 0));
+    }
+  }
+
+  void ErrorAnnotator::drawIndications(HWND handle, std::string_view document, int line, const LineError& lineError) const {
+    // Get line start position and length, which includes line end.
+    npp_position_t lineStart = ::SendMessage(handle, SCI_POSITIONFROMLINE, line, 0);
+    npp_position_t lineLength = ::SendMessage(handle, SCI_LINELENGTH, line, 0);
+    std::string_view lineText = (lineStart >= 0 && static_cast<size_t>(lineStart) < document.size()) ? document.substr(static_cast<size_t>(lineStart), static_cast<size_t>(lineLength)) : std::string_view();
+
+    for (int column : lineError.columns) {
+      size_t length = column >= 0 ? Tokenizer::tokenLength(lineText, static_cast<size_t>(column)) : 0;
       ::SendMessage(handle, SCI_INDICATORFILLRANGE, lineStart + column, length);
     }
   }
@@ -26,9 +26,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "..\..\external\npp\PluginInterface.h"
 
-#include <list>
-#include <map>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace papyrus {
 
@@ -40,21 +42,73 @@ namespace papyrus {
       // Clear the whole map and all annotations/indications on both views
       void clear();
 
+      // Replace errors of compiled scripts, where each scope is a compiled script or a directory whose scripts were all compiled.
+      // New errors are diffed against current ones per line, and only lines whose errors changed are redrawn
+      void annotate(const std::vector<std::wstring>& scopes, const std::vector<Error>& compilationErrors);
+
+      // Add errors on top of current ones, e.g. runtime errors, which are kept until their scripts are compiled again
+      void add(const std::vector<Error>& newErrors);
+
       // Annotate current buffer if it has errors
-      void annotate(const std::vector<Error>& compilationErrors);
       void annotate(npp_view_t view, std::wstring filePath);
 
+      // Check if errors of a file are being annotated
+      bool hasErrors(const std::wstring& filePath) const;
+
+      // Replace errors of a single file, e.g. from a background syntax check, and redraw changed lines on views showing it
+      void update(const std::wstring& filePath, const std::vector<Error>& fileErrors);
+
+      // Keep error lines of the document shown on given Scintilla view in sync with lines added (or deleted, if negative) after a line.
+      // Errors on deleted lines are dropped
+      void handleContentChange(HWND handle, int line, int linesAdded);
+
+      // Draw errors scrolled near the viewport of given Scintilla view, and release the ones scrolled far away
+      void handleScroll(HWND handle);
+
     private:
       struct LineError {
-        int line;
-        std::string message;
-        std::list<int> columns;
+        std::wstring text; // Messages of all errors on the line, only used while merging errors
+        std::string message; // Annotation text, converted from above once all errors are merged
+        std::vector<int> columns;
+
+        inline bool operator==(const LineError& other) const noexcept { return message == other.message && columns == other.columns; }
       };
 
-      using FileErrors = std::list<LineError>;
+      // Errors of a file. Error lines are kept as anchors, i.e. lines when errors were added, in ascending order, along with lines
+      // added or deleted by edits since then. Shifts are kept in a Fenwick tree indexed by anchor position, so an edit takes O(log n)
+      // rather than renumbering every error line after it.
+      struct FileErrors {
+        std::unordered_map<int, LineError> lineErrors; // Keyed by anchor
+        std::vector<int> anchors;
+        std::vector<int> shifts; // One-based Fenwick tree
+
+        // Current line of the anchor at given position
+        int line(size_t index) const noexcept;
 
-      // Annotate current buffer on a given view, if it has errors
-      void annotate(npp_view_t view);
+        // Position of the first anchor whose current line is after given line
+        size_t upperBound(int line) const noexcept;
+
+        // Shift current lines of anchors from given position on
+        void shift(size_t index, int linesAdded) noexcept;
+
+        // Turn current lines into anchors, dropping anchors in positions [first, last)
+        void rebase(size_t first = 0, size_t last = 0);
+      };
+
+      // Document lines that annotations and indications are drawn for on a view. Only visible lines plus a margin are drawn, so the cost
+      // of showing a file is bounded by screen size rather than number of errors.
+      struct Viewport {
+        std::wstring fileKey;
+        int firstLine {0};
+        int lastLine {-1};
+      };
+
+      // Merge errors into per-file line errors. Each file path is normalized once, and each line's annotation text
+      // is converted once, however many errors there are
+      static void addErrors(std::unordered_map<std::wstring, FileErrors>& fileErrorsMap, const std::vector<Error>& compilationErrors);
+
+      // Replace errors of a file with new ones, or none if null, and redraw lines whose errors changed on views showing it
+      void replaceErrors(const std::wstring& key, FileErrors* newFile);
 
       void clearAnnotations(HWND handle) const;
       void clearIndications(HWND handle) const;
@@ -67,7 +121,7 @@ namespace papyrus {
       void updateAnnotationStyle();
       void updateAnnotationStyle(npp_view_t view, HWND handle);
 
-      void drawAnnotations(HWND handle, const LineError& lineError) const;
+      void drawAnnotations(HWND handle, int line, const LineError& lineError) const;
 
       // Change indicator ID.
       // Scintilla reserves indicator 8-31 for containers. Notepad++ itself uses 8, and SciLexher.h defines most of IDs above 20, which NPP uses.
@@ -78,13 +132,26 @@ namespace papyrus {
       void updateIndicatorStyle(HWND handle) const;
       void updateIndicatorStyleOnFile(HWND handle, const std::wstring& filePath);
 
-      void drawIndications(HWND handle, const LineError& lineError) const;
+      // Read-only view of the document on a Scintilla view, from the start up to the end of given line, valid until the document is modified
+      std::string_view getDocument(HWND handle, int lastLine) const;
+
+      // Visible document lines of a Scintilla view, plus one screen of margin on each side
+      std::pair<int, int> getViewportLines(HWND handle) const;
+
+      inline Viewport& viewport(HWND handle) noexcept { return viewports[handle == nppData._scintillaMainHandle ? 0 : 1]; }
+
+      // Draw, or remove, annotations and indications of errors in a line range
+      void materialize(HWND handle, const FileErrors& file, int firstLine, int lastLine) const;
+      void release(HWND handle, const FileErrors& file, int firstLine, int lastLine) const;
+
+      void drawIndications(HWND handle, std::string_view document, int line, const LineError& lineError) const;
 
       // Private members
       //
       const NppData& nppData;
       const ErrorAnnotatorSettings& settings;
-      std::map<std::wstring, FileErrors> errors;
+      std::unordered_map<std::wstring, FileErrors> errors; // Keyed by upper case file path
+      Viewport viewports[2]; // Main view and second view
 
       int indicatorID {0};
       int allocatedIndicatorID {0};
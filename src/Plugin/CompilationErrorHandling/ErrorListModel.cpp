@@ -0,0 +1,179 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ErrorListModel.hpp"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace papyrus {
+
+  void ErrorListModel::clear() {
+    errors.clear();
+    entries.clear();
+    files.clear();
+    fileIndices.clear();
+    byFile.clear();
+    byLine.clear();
+    byMessage.clear();
+    rows.clear();
+  }
+
+  void ErrorListModel::append(const std::vector<Error>& newErrors) {
+    size_t first = errors.size();
+    errors.insert(errors.end(), newErrors.begin(), newErrors.end());
+    for (size_t i = first; i < errors.size(); ++i) {
+      const Error& error = errors[i];
+      auto [fileIndex, inserted] = fileIndices.try_emplace(error.file, files.size());
+      if (inserted) {
+        size_t separator = error.file.find_last_of(L"\\/");
+        File& file = files.emplace_back(toKey(error.file), separator == std::wstring::npos ? error.file : error.file.substr(separator + 1));
+        file.matched = (file.key.find(fileFilterKey) != std::wstring::npos);
+      }
+      Entry& entry = entries.emplace_back(fileIndex->second, toKey(error.message));
+      entry.matched = (entry.messageKey.find(textFilterKey) != std::wstring::npos);
+    }
+
+    // New errors are sorted among themselves, then merged into each existing order.
+    for (SortKey key : { SortKey::File, SortKey::Line, SortKey::Message }) {
+      std::vector<size_t>& order = permutation(key);
+      auto compare = [this, key](size_t index1, size_t index2) { return less(key, index1, index2); };
+      size_t middle = order.size();
+      for (size_t i = first; i < errors.size(); ++i) {
+        order.push_back(i);
+      }
+      std::sort(order.begin() + middle, order.end(), compare);
+      std::inplace_merge(order.begin(), order.begin() + middle, order.end(), compare);
+    }
+
+    auto compare = [this](size_t index1, size_t index2) { return less(activeSortKey, index1, index2); };
+    size_t middle = rows.size();
+    for (size_t i = first; i < errors.size(); ++i) {
+      if (isShown(i)) {
+        rows.push_back(i);
+      }
+    }
+    std::sort(rows.begin() + middle, rows.end(), compare);
+    std::inplace_merge(rows.begin(), rows.begin() + middle, rows.end(), compare);
+  }
+
+  void ErrorListModel::sort(SortKey key, bool ascendingOrder) {
+    ascending = ascendingOrder;
+    if (key != activeSortKey) {
+      activeSortKey = key;
+      updateRows();
+    }
+  }
+
+  void ErrorListModel::filter(const std::wstring& fileFilter, const std::wstring& textFilter) {
+    std::wstring newFileFilterKey = toKey(fileFilter);
+    std::wstring newTextFilterKey = toKey(textFilter);
+    if (newFileFilterKey == fileFilterKey && newTextFilterKey == textFilterKey) {
+      return;
+    }
+
+    // A filter containing the previous one only narrows, so errors that didn't match before don't need to be checked
+    // again. Likewise one contained in the previous filter only widens, so errors that matched still match.
+    auto refilter = [](auto& items, const std::wstring& previousKey, const std::wstring& newKey, auto keyOf) {
+      bool narrowing = (newKey.find(previousKey) != std::wstring::npos);
+      bool widening = (previousKey.find(newKey) != std::wstring::npos);
+      for (auto& item : items) {
+        if ((item.matched && !widening) || (!item.matched && !narrowing)) {
+          item.matched = (keyOf(item).find(newKey) != std::wstring::npos);
+        }
+      }
+    };
+    if (newFileFilterKey != fileFilterKey) {
+      refilter(files, fileFilterKey, newFileFilterKey, [](const File& file) -> const std::wstring& { return file.key; });
+      fileFilterKey = std::move(newFileFilterKey);
+    }
+    if (newTextFilterKey != textFilterKey) {
+      refilter(entries, textFilterKey, newTextFilterKey, [](const Entry& entry) -> const std::wstring& { return entry.messageKey; });
+      textFilterKey = std::move(newTextFilterKey);
+    }
+    updateRows();
+  }
+
+  // Private methods
+  //
+
+  bool ErrorListModel::less(SortKey key, size_t index1, size_t index2) const noexcept {
+    const Error& error1 = errors[index1];
+    const Error& error2 = errors[index2];
+    const Entry& entry1 = entries[index1];
+    const Entry& entry2 = entries[index2];
+    if (key == SortKey::Message) {
+      int order = entry1.messageKey.compare(entry2.messageKey);
+      if (order != 0) {
+        return order < 0;
+      }
+    }
+    if (key == SortKey::Line && error1.line != error2.line) {
+      return error1.line < error2.line;
+    }
+    if (key == SortKey::Line && error1.column != error2.column) {
+      return error1.column < error2.column;
+    }
+    if (entry1.file != entry2.file) {
+      int order = files[entry1.file].key.compare(files[entry2.file].key);
+      if (order != 0) {
+        return order < 0;
+      }
+    }
+    if (error1.line != error2.line) {
+      return error1.line < error2.line;
+    }
+    if (error1.column != error2.column) {
+      return error1.column < error2.column;
+    }
+    return index1 < index2;
+  }
+
+  std::vector<size_t>& ErrorListModel::permutation(SortKey key) noexcept {
+    switch (key) {
+      case SortKey::Line: {
+        return byLine;
+      }
+
+      case SortKey::Message: {
+        return byMessage;
+      }
+
+      default: {
+        return byFile;
+      }
+    }
+  }
+
+  void ErrorListModel::updateRows() {
+    rows.clear();
+    for (size_t i : permutation(activeSortKey)) {
+      if (isShown(i)) {
+        rows.push_back(i);
+      }
+    }
+  }
+
+  std::wstring ErrorListModel::toKey(const std::wstring& str) {
+    std::wstring key(str);
+    std::transform(key.begin(), key.end(), key.begin(), [](wchar_t ch) { return static_cast<wchar_t>(std::towupper(ch)); });
+    return key;
+  }
+
+} // namespace
@@ -0,0 +1,97 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "Error.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace papyrus {
+
+  // Errors shown on errors window, kept apart from the list control so the window only asks for rows it draws.
+  // Each sort order is kept as a permutation of error indices, so switching between them doesn't sort again.
+  // Rows passing filters are tracked incrementally as filters change and errors are appended.
+  class ErrorListModel {
+    public:
+      enum class SortKey {
+        File,   // File, line, column
+        Line,   // Line, column, file
+        Message // Message, file, line, column
+      };
+
+      void clear();
+
+      // Append errors without sorting or filtering existing ones again
+      void append(const std::vector<Error>& newErrors);
+
+      void sort(SortKey key, bool ascending);
+      inline SortKey sortKey() const noexcept { return activeSortKey; }
+      inline bool isAscending() const noexcept { return ascending; }
+
+      // Only show errors whose file path contains fileFilter and whose message contains textFilter, case-insensitive
+      void filter(const std::wstring& fileFilter, const std::wstring& textFilter);
+
+      inline size_t size() const noexcept { return rows.size(); }
+      const Error& error(size_t row) const noexcept { return errors[index(row)]; }
+      const std::wstring& fileName(size_t row) const noexcept { return files[entries[index(row)].file].name; }
+
+    private:
+      struct File {
+        std::wstring key; // Upper case file path
+        std::wstring name;
+        bool matched {true};
+      };
+
+      struct Entry {
+        size_t file {0};
+        std::wstring messageKey; // Upper case message
+        bool matched {true};
+      };
+
+      inline size_t index(size_t row) const noexcept { return rows[ascending ? row : rows.size() - 1 - row]; }
+      inline bool isShown(size_t index) const noexcept { return entries[index].matched && files[entries[index].file].matched; }
+
+      // Strict weak ordering of error indices by a sort key. Ties are broken by index so every order is total
+      bool less(SortKey key, size_t index1, size_t index2) const noexcept;
+      std::vector<size_t>& permutation(SortKey key) noexcept;
+
+      void updateRows();
+
+      static std::wstring toKey(const std::wstring& str);
+
+      // Private members
+      //
+      std::vector<Error> errors;
+      std::vector<Entry> entries;
+      std::vector<File> files;
+      std::unordered_map<std::wstring, size_t> fileIndices; // Keyed by file path as reported
+      std::vector<size_t> byFile;
+      std::vector<size_t> byLine;
+      std::vector<size_t> byMessage;
+      std::vector<size_t> rows; // Indices of shown errors, in ascending order of active sort key
+      SortKey activeSortKey {SortKey::File};
+      bool ascending {true};
+      std::wstring fileFilterKey;
+      std::wstring textFilterKey;
+  };
+
+} // namespace
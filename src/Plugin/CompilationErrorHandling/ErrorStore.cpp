@@ -0,0 +1,167 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// For the time being, as there is no good alternative way in C++17 to get stream working than using codecvt
+#define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+
+#include "ErrorStore.hpp"
+
+#include "..\Common\StringUtil.hpp"
+
+#include "..\..\external\gsl\include\gsl\util"
+
+#include <algorithm>
+#include <chrono>
+#include <codecvt>
+#include <fstream>
+
+namespace papyrus {
+
+  namespace {
+    constexpr size_t MAX_STORED_FILES = 500;
+
+    int strToInt(const std::wstring& str) noexcept {
+      try {
+        return std::stoi(str);
+      } catch (...) {
+        return 0;
+      }
+    }
+
+    std::int64_t strToInt64(const std::wstring& str) noexcept {
+      try {
+        return std::stoll(str);
+      } catch (...) {
+        return 0;
+      }
+    }
+  }
+
+  void ErrorStore::update(const std::vector<std::wstring>& scopes, const std::vector<Error>& errors) {
+    if (!loaded) {
+      load();
+    }
+
+    for (const auto& scope : scopes) {
+      std::wstring scopeKey = utility::toUpper(scope);
+      std::erase_if(entries, [&](const auto& entry) {
+        return entry.first == scopeKey || utility::startsWith(entry.first, scopeKey + L"\\");
+      });
+    }
+
+    std::int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    for (const auto& error : errors) {
+      std::wstring key = utility::toUpper(error.file);
+      auto iter = entries.find(key);
+      if (iter == entries.end()) {
+        Entry entry { .updateTime = now };
+        if (!utility::hashFile(error.file, entry.hash)) {
+          continue;
+        }
+        iter = entries.emplace(key, std::move(entry)).first;
+      }
+      iter->second.errors.push_back(error);
+    }
+
+    while (entries.size() > MAX_STORED_FILES) {
+      entries.erase(std::min_element(entries.begin(), entries.end(), [](const auto& entry1, const auto& entry2) { return entry1.second.updateTime < entry2.second.updateTime; }));
+    }
+    save();
+  }
+
+  bool ErrorStore::find(const std::wstring& filePath, std::vector<Error>& errors) {
+    if (!loaded) {
+      load();
+    }
+
+    auto iter = entries.find(utility::toUpper(filePath));
+    if (iter == entries.end()) {
+      return false;
+    }
+
+    utility::hash_t hash;
+    if (!utility::hashFile(filePath, hash) || hash != iter->second.hash) {
+      // Stored errors no longer apply.
+      entries.erase(iter);
+      save();
+      return false;
+    }
+
+    errors = iter->second.errors;
+    for (auto& error : errors) {
+      error.file = filePath;
+    }
+    return true;
+  }
+
+  // Private methods
+  //
+
+  void ErrorStore::load() {
+    loaded = true;
+    entries.clear();
+    if (storePath.empty()) {
+      return;
+    }
+
+    std::wifstream storeFile(storePath);
+    storeFile.imbue(std::locale(storeFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+    std::wstring line;
+    while (std::getline(storeFile, line)) {
+      // Message goes last as it may contain the separator itself.
+      std::vector<std::wstring> fields;
+      size_t start = 0;
+      for (size_t end; fields.size() < 5 && (end = line.find(L'|', start)) != std::wstring::npos; start = end + 1) {
+        fields.push_back(line.substr(start, end - start));
+      }
+      if (fields.size() != 5) {
+        continue;
+      }
+
+      Error error {
+        .file = fields[4],
+        .message = line.substr(start),
+        .line = strToInt(fields[2]),
+        .column = strToInt(fields[3])
+      };
+      Entry& entry = entries[utility::toUpper(error.file)];
+      entry.hash = utility::strToHash(fields[0]);
+      entry.updateTime = strToInt64(fields[1]);
+      entry.errors.push_back(std::move(error));
+    }
+  }
+
+  void ErrorStore::save() const {
+    if (!storePath.empty()) {
+      std::wofstream storeFile(storePath, std::wofstream::trunc);
+      auto autoCleanup = gsl::finally([&] { storeFile.close(); });
+      storeFile.imbue(std::locale(storeFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+
+      // Each line is one error, with the format of: source hash|update time|line|column|file path|message
+      for (const auto& [key, entry] : entries) {
+        for (const auto& error : entry.errors) {
+          storeFile << utility::hashToStr(entry.hash) << L'|' << entry.updateTime << L'|' << error.line << L'|' << error.column << L'|'
+            << error.file << L'|' << error.message << std::endl;
+        }
+      }
+    }
+  }
+
+} // namespace
@@ -0,0 +1,64 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "Error.hpp"
+
+#include "..\Common\HashUtil.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace papyrus {
+
+  // Compilation errors of each script along with hash of the source they were reported on, persisted in a file, so
+  // errors of a script that hasn't changed since can be shown again after Notepad++ restarts without compiling it.
+  class ErrorStore {
+    public:
+      inline void init(const std::wstring& path) { storePath = path; }
+
+      // Replace stored errors of compiled scripts with new ones. Each scope is a compiled script, or a directory whose
+      // scripts were all compiled. Errors are stored against current content of their files, then store is saved
+      void update(const std::vector<std::wstring>& scopes, const std::vector<Error>& errors);
+
+      // Get stored errors of a script. Entry is dropped if script has changed since errors were reported
+      bool find(const std::wstring& filePath, std::vector<Error>& errors);
+
+    private:
+      struct Entry {
+        utility::hash_t hash {0};
+        std::int64_t updateTime {0}; // Seconds since epoch, used to drop least recently updated entries when store is full
+        std::vector<Error> errors;
+      };
+
+      void load();
+      void save() const;
+
+      // Private members
+      //
+      std::wstring storePath;
+      bool loaded {false};
+      std::map<std::wstring, Entry> entries; // Keyed by upper case file path
+  };
+
+} // namespace
@@ -24,12 +24,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "..\..\external\npp\Notepad_plus_msgs.h"
 
-#include <filesystem>
+#include <string>
 
 #include <commctrl.h>
 
 namespace papyrus {
 
+  namespace {
+    constexpr int FILTER_HEIGHT = 20; // In pixels
+  }
+
   ErrorsWindow::ErrorsWindow(HINSTANCE instance, HWND parent, HWND pluginMessageWindow)
    : DockingDlgInterface(IDD_ERRORS_WINDOW), pluginMessageWindow(pluginMessageWindow) {
     DockingDlgInterface::init(instance, parent);
@@ -43,6 +47,10 @@ namespace papyrus {
     ::SendMessage(parent, NPPM_DMMREGASDCKDLG, 0, reinterpret_cast<LPARAM>(&data));
     display(false);
     listView = ::GetDlgItem(getHSelf(), IDC_ERRORS_LIST);
+    fileFilter = ::GetDlgItem(getHSelf(), IDC_ERRORS_FILE_FILTER);
+    textFilter = ::GetDlgItem(getHSelf(), IDC_ERRORS_TEXT_FILTER);
+    Edit_SetCueBannerText(fileFilter, L"Filter by file");
+    Edit_SetCueBannerText(textFilter, L"Filter by message");
     ListView_SetExtendedListViewStyle(listView, LVS_EX_FULLROWSELECT);
     LVCOLUMN column {
       .mask = LVCF_WIDTH | LVCF_TEXT,
@@ -59,32 +67,19 @@ namespace papyrus {
     column.cx = 45;
     column.pszText = const_cast<LPWSTR>(L"Col");
     ListView_InsertColumn(listView, 3, &column);
+    updateSortIndicator(0);
     resize();
   }
 
-  void ErrorsWindow::show(const std::vector<Error>& compilationErrors) {
-    errors = compilationErrors;
-    for (int i = 0; i < static_cast<int>(errors.size()); ++i) {
-      std::wstring filename = std::filesystem::path(errors[i].file).filename();
-      LVITEM item {
-        .mask = LVIF_TEXT,
-        .iItem = i,
-        .pszText = const_cast<LPWSTR>(filename.c_str())
-      };
-      ListView_InsertItem(listView, &item);
-      item.iSubItem = 1;
-      item.pszText = const_cast<LPWSTR>(errors[i].message.c_str());
-      ListView_SetItem(listView, &item);
-      item.iSubItem = 2;
-      std::wstring line = std::to_wstring(errors[i].line);
-      item.pszText = const_cast<LPWSTR>(line.c_str());
-      ListView_SetItem(listView, &item);
-      item.iSubItem = 3;
-      std::wstring column = std::to_wstring(errors[i].column);
-      item.pszText = const_cast<LPWSTR>(column.c_str());
-      ListView_SetItem(listView, &item);
-    }
-    display();
+  void ErrorsWindow::append(const std::vector<Error>& compilationErrors) {
+    model.append(compilationErrors);
+    ListView_SetItemCountEx(listView, static_cast<int>(model.size()), LVSICF_NOSCROLL);
+    ::InvalidateRect(listView, nullptr, FALSE);
+  }
+
+  void ErrorsWindow::clear() {
+    model.clear();
+    refresh();
   }
 
   // Protected methods
@@ -97,19 +92,47 @@ namespace papyrus {
         return 0;
       }
 
-      case WM_NOTIFY: {
-        NMITEMACTIVATE* item = reinterpret_cast<NMITEMACTIVATE*>(lParam);
-        if (item->hdr.hwndFrom == listView && item->hdr.code == NM_DBLCLK) {
-          if (item->iItem != -1) {
-            Error error = errors[item->iItem];
-            ::SendMessage(pluginMessageWindow, PPM_JUMP_TO_ERROR, reinterpret_cast<WPARAM>(&error), 0);
-          }
+      case WM_COMMAND: {
+        if (HIWORD(wParam) == EN_CHANGE && (LOWORD(wParam) == IDC_ERRORS_FILE_FILTER || LOWORD(wParam) == IDC_ERRORS_TEXT_FILTER)) {
+          updateFilter();
           return true;
         } else {
           return DockingDlgInterface::run_dlgProc(message, wParam, lParam);
         }
       }
 
+      case WM_NOTIFY: {
+        NMHDR* header = reinterpret_cast<NMHDR*>(lParam);
+        if (header->hwndFrom != listView) {
+          return DockingDlgInterface::run_dlgProc(message, wParam, lParam);
+        }
+
+        switch (header->code) {
+          case NM_DBLCLK: {
+            NMITEMACTIVATE* item = reinterpret_cast<NMITEMACTIVATE*>(lParam);
+            if (item->iItem >= 0 && item->iItem < static_cast<int>(model.size())) {
+              Error error = model.error(item->iItem);
+              ::SendMessage(pluginMessageWindow, PPM_JUMP_TO_ERROR, reinterpret_cast<WPARAM>(&error), 0);
+            }
+            return true;
+          }
+
+          case LVN_GETDISPINFO: {
+            getDisplayInfo(reinterpret_cast<NMLVDISPINFO*>(lParam)->item);
+            return true;
+          }
+
+          case LVN_COLUMNCLICK: {
+            sortByColumn(reinterpret_cast<NMLISTVIEW*>(lParam)->iSubItem);
+            return true;
+          }
+
+          default: {
+            return DockingDlgInterface::run_dlgProc(message, wParam, lParam);
+          }
+        }
+      }
+
       default: {
         return DockingDlgInterface::run_dlgProc(message, wParam, lParam);
       }
@@ -122,15 +145,76 @@ namespace papyrus {
   void ErrorsWindow::resize() const {
     RECT windowSize {};
     ::GetClientRect(getHSelf(), &windowSize);
-    ::SetWindowPos(listView, HWND_TOP, 2, 2, windowSize.right - windowSize.left - 4, windowSize.bottom - windowSize.top - 2, 0);
-    int width = ListView_GetColumnWidth(listView, 0) + ListView_GetColumnWidth(listView, 2) + ListView_GetColumnWidth(listView, 3) + 8;
+    int fileColWidth = ListView_GetColumnWidth(listView, 0);
+    ::SetWindowPos(fileFilter, HWND_TOP, 2, 2, fileColWidth, FILTER_HEIGHT, 0);
+    ::SetWindowPos(textFilter, HWND_TOP, fileColWidth + 4, 2, windowSize.right - windowSize.left - fileColWidth - 6, FILTER_HEIGHT, 0);
+    ::SetWindowPos(listView, HWND_TOP, 2, FILTER_HEIGHT + 4, windowSize.right - windowSize.left - 4, windowSize.bottom - windowSize.top - FILTER_HEIGHT - 4, 0);
+    int width = fileColWidth + ListView_GetColumnWidth(listView, 2) + ListView_GetColumnWidth(listView, 3) + 8;
     LONG messageColWidth = windowSize.right - windowSize.left - width;
     ListView_SetColumnWidth(listView, 1, messageColWidth);
   }
 
-  void ErrorsWindow::clear() {
-    ListView_DeleteAllItems(listView);
-    errors.clear();
+  void ErrorsWindow::refresh() const {
+    // Selected row would point to a different error after rows change.
+    ListView_SetItemState(listView, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+    ListView_SetItemCountEx(listView, static_cast<int>(model.size()), LVSICF_NOSCROLL);
+    ::InvalidateRect(listView, nullptr, FALSE);
+  }
+
+  void ErrorsWindow::getDisplayInfo(LVITEM& item) const {
+    if (!(item.mask & LVIF_TEXT) || item.iItem < 0 || item.iItem >= static_cast<int>(model.size())) {
+      return;
+    }
+
+    const Error& error = model.error(item.iItem);
+    switch (item.iSubItem) {
+      case 0: {
+        ::wcsncpy_s(item.pszText, item.cchTextMax, model.fileName(item.iItem).c_str(), _TRUNCATE);
+        break;
+      }
+
+      case 1: {
+        ::wcsncpy_s(item.pszText, item.cchTextMax, error.message.c_str(), _TRUNCATE);
+        break;
+      }
+
+      default: {
+        std::wstring number = std::to_wstring(item.iSubItem == 2 ? error.line : error.column);
+        ::wcsncpy_s(item.pszText, item.cchTextMax, number.c_str(), _TRUNCATE);
+        break;
+      }
+    }
+  }
+
+  void ErrorsWindow::sortByColumn(int column) {
+    // Clicking the column list is sorted by reverses the order. Line and Col columns both sort by line, then column.
+    ErrorListModel::SortKey key = (column == 0 ? ErrorListModel::SortKey::File : (column == 1 ? ErrorListModel::SortKey::Message : ErrorListModel::SortKey::Line));
+    model.sort(key, key != model.sortKey() || !model.isAscending());
+    updateSortIndicator(column);
+    refresh();
+  }
+
+  void ErrorsWindow::updateSortIndicator(int column) const {
+    HWND header = ListView_GetHeader(listView);
+    for (int i = 0; i < Header_GetItemCount(header); ++i) {
+      HDITEM headerItem { .mask = HDI_FORMAT };
+      Header_GetItem(header, i, &headerItem);
+      headerItem.fmt &= ~(HDF_SORTUP | HDF_SORTDOWN);
+      if (i == column) {
+        headerItem.fmt |= (model.isAscending() ? HDF_SORTUP : HDF_SORTDOWN);
+      }
+      Header_SetItem(header, i, &headerItem);
+    }
+  }
+
+  void ErrorsWindow::updateFilter() {
+    auto getText = [](HWND edit) {
+      std::wstring text(::GetWindowTextLength(edit) + 1, L'\0');
+      text.resize(::GetWindowText(edit, text.data(), static_cast<int>(text.size())));
+      return text;
+    };
+    model.filter(getText(fileFilter), getText(textFilter));
+    refresh();
   }
 
 } // namespace
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include "Error.hpp"
+#include "ErrorListModel.hpp"
 
 #include "..\..\external\npp\DockingDlgInterface.h"
 #include "..\..\external\npp\PluginInterface.h"
@@ -36,21 +37,32 @@ namespace papyrus {
     public:
       ErrorsWindow(HINSTANCE instance, HWND parent, HWND pluginMessageWindow);
 
-      void show(const std::vector<Error>& compilationErrors);
       inline void hide() { display(false); }
       void clear();
 
+      // Add errors to the list as they come, without reloading what is already listed
+      void append(const std::vector<Error>& compilationErrors);
+
     protected:
       INT_PTR CALLBACK run_dlgProc(UINT message, WPARAM wParam, LPARAM lParam) override;
 
     private:
       void resize() const;
 
+      // List is in owner data mode, so only item count is set, and list asks for text of rows it draws
+      void refresh() const;
+      void getDisplayInfo(LVITEM& item) const;
+      void sortByColumn(int column);
+      void updateSortIndicator(int column) const;
+      void updateFilter();
+
       // Private members
       //
       HWND pluginMessageWindow;
       HWND listView;
-      std::vector<Error> errors;
+      HWND fileFilter;
+      HWND textFilter;
+      ErrorListModel model;
   };
 
 } // namespace
@@ -0,0 +1,270 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// For the time being, as there is no good alternative way in C++17 to get stream working than using codecvt
+#define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+
+#include "CompilationHistory.hpp"
+
+#include "..\Common\StringUtil.hpp"
+
+#include "..\..\external\gsl\include\gsl\util"
+
+#include <algorithm>
+#include <codecvt>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace papyrus {
+
+  namespace {
+    constexpr size_t MAX_HISTORY_RECORDS = 500;
+    constexpr size_t MAX_REPORTED_SCRIPTS = 15;
+
+    // Error volumes that total time is reported by, as large error counts shift time from compiler to parsing and reporting
+    struct ErrorVolume {
+      size_t minErrors;
+      const wchar_t* name;
+    };
+    const ErrorVolume errorVolumes[] {
+      { 0, L"No errors" },
+      { 1, L"1-99 errors" },
+      { 100, L"100-9999 errors" },
+      { 10000, L"10000+ errors" }
+    };
+
+    const wchar_t* phaseNames[] {
+      L"Preparation",
+      L"Process startup",
+      L"Compiler",
+      L"Pipe reads",
+      L"Error parsing",
+      L"Anonymization",
+      L"Error reporting"
+    };
+
+    // Nearest-rank percentile of sorted durations
+    CompilationRecord::duration_t percentile(const std::vector<CompilationRecord::duration_t>& sortedDurations, int percent) {
+      if (sortedDurations.empty()) {
+        return CompilationRecord::duration_t::zero();
+      }
+      size_t rank = (sortedDurations.size() * percent + 99) / 100;
+      return sortedDurations[std::max<size_t>(rank, 1) - 1];
+    }
+
+    std::wstring formatDuration(CompilationRecord::duration_t duration) {
+      return std::format(L"{:.3f}s", duration.count() / 1000000.0);
+    }
+
+    std::wstring formatPercentiles(std::vector<CompilationRecord::duration_t>& durations) {
+      std::sort(durations.begin(), durations.end());
+      return std::format(L"({} runs): {} / {} / {}", durations.size(), formatDuration(percentile(durations, 50)), formatDuration(percentile(durations, 90)), formatDuration(percentile(durations, 99)));
+    }
+
+    std::int64_t strToInt64(const std::wstring& str) noexcept {
+      try {
+        return std::stoll(str);
+      } catch (...) {
+        return 0;
+      }
+    }
+  }
+
+  CompilationRecord::duration_t CompilationRecord::total() const noexcept {
+    duration_t total {};
+    for (const auto& phase : phases) {
+      total += phase;
+    }
+    return total;
+  }
+
+  void CompilationHistory::add(const CompilationRecord& record) {
+    add(std::vector<CompilationRecord> { record });
+  }
+
+  void CompilationHistory::add(const std::vector<CompilationRecord>& newRecords) {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    if (!loaded) {
+      load();
+    }
+
+    records.insert(records.end(), newRecords.begin(), newRecords.end());
+    while (records.size() > MAX_HISTORY_RECORDS) {
+      records.pop_front();
+    }
+    save();
+  }
+
+  std::wstring CompilationHistory::report() {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    if (!loaded) {
+      load();
+    }
+    if (records.empty()) {
+      return L"No compilation has been recorded yet.";
+    }
+
+    std::map<Game, std::vector<CompilationRecord::duration_t>> gameDurations;
+    std::vector<std::pair<std::wstring, std::vector<CompilationRecord::duration_t>>> scriptDurations; // Most recently compiled first
+    std::array<std::vector<CompilationRecord::duration_t>, std::to_underlying(CompilationRecord::Phase::COUNT)> phaseDurations;
+    std::array<std::vector<CompilationRecord::duration_t>, std::size(errorVolumes)> errorVolumeDurations;
+    std::vector<std::uint64_t> peakMemories;
+    std::uint64_t outputBytes {0};
+    size_t errorCount {0};
+    CompilationRecord::duration_t outputTime {}; // Compiler run and pipe reads, during which output is produced
+    CompilationRecord::duration_t parsingTime {};
+    for (auto iter = records.rbegin(); iter != records.rend(); ++iter) {
+      gameDurations[iter->game].push_back(iter->total());
+
+      std::wstring scriptName = std::filesystem::path(iter->filePath).filename().wstring();
+      if (iter->scriptCount > 1) {
+        scriptName += L" + " + std::to_wstring(iter->scriptCount - 1) + L" more";
+      }
+      auto script = std::find_if(scriptDurations.begin(), scriptDurations.end(), [&](const auto& entry) { return entry.first == scriptName; });
+      if (script == scriptDurations.end()) {
+        script = scriptDurations.insert(scriptDurations.end(), std::make_pair(scriptName, std::vector<CompilationRecord::duration_t>()));
+      }
+      script->second.push_back(iter->total());
+
+      for (size_t i = 0; i < phaseDurations.size(); ++i) {
+        phaseDurations[i].push_back(iter->phases[i]);
+      }
+      size_t volume = std::size(errorVolumes) - 1;
+      while (volume > 0 && iter->errorCount < errorVolumes[volume].minErrors) {
+        --volume;
+      }
+      errorVolumeDurations[volume].push_back(iter->total());
+
+      if (iter->peakMemory > 0) {
+        peakMemories.push_back(iter->peakMemory);
+      }
+      outputBytes += iter->outputBytes;
+      errorCount += iter->errorCount;
+      outputTime += (*iter)[CompilationRecord::Phase::Compiler] + (*iter)[CompilationRecord::Phase::PipeRead];
+      parsingTime += (*iter)[CompilationRecord::Phase::ErrorParsing];
+    }
+
+    std::wstring result = std::format(L"Last {} compilation(s), total time p50 / p90 / p99\r\n\r\nBy game:", records.size());
+    for (auto& [game, durations] : gameDurations) {
+      result += L"\r\n    " + game::gameNames[std::to_underlying(game)].second + L" " + formatPercentiles(durations);
+    }
+
+    result += L"\r\n\r\nBy script:";
+    for (size_t i = 0; i < scriptDurations.size() && i < MAX_REPORTED_SCRIPTS; ++i) {
+      result += L"\r\n    " + scriptDurations[i].first + L" " + formatPercentiles(scriptDurations[i].second);
+    }
+    if (scriptDurations.size() > MAX_REPORTED_SCRIPTS) {
+      result += L"\r\n    ...";
+    }
+
+    result += L"\r\n\r\nBy error volume:";
+    for (size_t i = 0; i < errorVolumeDurations.size(); ++i) {
+      if (!errorVolumeDurations[i].empty()) {
+        result += L"\r\n    " + std::wstring(errorVolumes[i].name) + L" " + formatPercentiles(errorVolumeDurations[i]);
+      }
+    }
+
+    result += L"\r\n\r\nPhase medians:";
+    for (size_t i = 0; i < phaseDurations.size(); ++i) {
+      std::sort(phaseDurations[i].begin(), phaseDurations[i].end());
+      result += std::format(L"\r\n    {}: {}", phaseNames[i], formatDuration(percentile(phaseDurations[i], 50)));
+    }
+    result += std::format(L"\r\n\r\nAverage compiler output: {} bytes, {:.1f} error(s)", outputBytes / records.size(), static_cast<double>(errorCount) / records.size());
+    if (outputTime.count() > 0) {
+      result += std::format(L"\r\nCompiler output throughput: {:.1f} KiB/s", outputBytes / 1024.0 / (outputTime.count() / 1000000.0));
+    }
+    if (parsingTime.count() > 0 && errorCount > 0) {
+      result += std::format(L"\r\nError parsing throughput: {:.0f} errors/s", errorCount / (parsingTime.count() / 1000000.0));
+    }
+    if (!peakMemories.empty()) {
+      std::sort(peakMemories.begin(), peakMemories.end());
+      result += std::format(L"\r\nCompiler peak memory p50 / max: {:.1f} / {:.1f} MiB", peakMemories[(peakMemories.size() - 1) / 2] / 1048576.0, peakMemories.back() / 1048576.0);
+    }
+    return result;
+  }
+
+  // Private methods
+  //
+
+  void CompilationHistory::load() {
+    loaded = true;
+    records.clear();
+    if (historyPath.empty()) {
+      return;
+    }
+
+    std::wifstream historyFile(historyPath);
+    historyFile.imbue(std::locale(historyFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+    std::wstring line;
+    while (std::getline(historyFile, line)) {
+      // Records saved before peak memory was tracked have one field less.
+      auto fields = utility::split(line, L"|");
+      if (fields.size() != 8 && fields.size() != 9) {
+        continue;
+      }
+
+      auto game = game::gameAliases.find(fields[1]);
+      auto phases = utility::split(fields[6], L",");
+      if (game == game::gameAliases.end() || phases.size() != std::to_underlying(CompilationRecord::Phase::COUNT)) {
+        continue;
+      }
+
+      CompilationRecord record {
+        .startTime = strToInt64(fields[0]),
+        .game = game->second,
+        .filePath = fields.back(),
+        .scriptCount = static_cast<size_t>(strToInt64(fields[2])),
+        .succeeded = utility::strToBool(fields[3]),
+        .outputBytes = static_cast<std::uint64_t>(strToInt64(fields[4])),
+        .errorCount = static_cast<size_t>(strToInt64(fields[5])),
+        .peakMemory = fields.size() > 8 ? static_cast<std::uint64_t>(strToInt64(fields[7])) : 0
+      };
+      for (size_t i = 0; i < phases.size(); ++i) {
+        record.phases[i] = CompilationRecord::duration_t(strToInt64(phases[i]));
+      }
+      records.push_back(record);
+    }
+    while (records.size() > MAX_HISTORY_RECORDS) {
+      records.pop_front();
+    }
+  }
+
+  void CompilationHistory::save() const {
+    if (!historyPath.empty()) {
+      std::wofstream historyFile(historyPath, std::wofstream::trunc);
+      auto autoCleanup = gsl::finally([&] { historyFile.close(); });
+      historyFile.imbue(std::locale(historyFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+
+      // Each line has the format of: start time|game|script count|succeeded|output bytes|error count|phase durations in microseconds|peak memory|file path
+      for (const auto& record : records) {
+        historyFile << record.startTime << L'|' << game::gameNames[std::to_underlying(record.game)].first << L'|' << record.scriptCount << L'|'
+          << utility::boolToStr(record.succeeded) << L'|' << record.outputBytes << L'|' << record.errorCount << L'|';
+        for (size_t i = 0; i < record.phases.size(); ++i) {
+          historyFile << (i > 0 ? L"," : L"") << record.phases[i].count();
+        }
+        historyFile << L'|' << record.peakMemory << L'|' << record.filePath << std::endl;
+      }
+    }
+  }
+
+} // namespace
@@ -0,0 +1,106 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "..\Common\Game.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace papyrus {
+
+  using Game = game::Game;
+
+  // Timing and size information of one compilation
+  struct CompilationRecord {
+    enum class Phase {
+      Preparation,    // Scanning scripts and looking up compiled output cache
+      ProcessStartup, // Creating pipes and compiler process
+      Compiler,       // Compiler process running, excluding time spent on reading its output
+      PipeRead,       // Reading and decoding compiler output
+      ErrorParsing,
+      Anonymization,
+      ErrorReporting, // Showing errors in errors window and annotating them, done by UI thread
+      COUNT
+    };
+
+    using duration_t = std::chrono::microseconds;
+
+    std::int64_t startTime {0}; // Seconds since epoch
+    Game game {Game::Auto};
+    std::wstring filePath; // First compiled script, or source directory of an incremental build
+    size_t scriptCount {0};
+    bool succeeded {false};
+    std::uint64_t outputBytes {0}; // Bytes read from compiler's stdout and stderr
+    size_t errorCount {0};
+    std::uint64_t peakMemory {0}; // Peak memory used by compiler's process tree, in bytes
+    std::array<duration_t, std::to_underlying(Phase::COUNT)> phases {};
+
+    inline duration_t& operator[](Phase phase) noexcept { return phases[std::to_underlying(phase)]; }
+    duration_t total() const noexcept;
+  };
+
+  // Measures time spent on a phase, from construction to destruction, and adds it to the record
+  class PhaseTimer {
+    public:
+      inline PhaseTimer(CompilationRecord& record, CompilationRecord::Phase phase) : record(record), phase(phase), start(std::chrono::steady_clock::now()) {}
+      inline ~PhaseTimer() { record[phase] += std::chrono::duration_cast<CompilationRecord::duration_t>(std::chrono::steady_clock::now() - start); }
+
+      // Disable all copy/move constructors/assignment operators
+      PhaseTimer(PhaseTimer&& other) = delete;
+
+    private:
+      CompilationRecord& record;
+      CompilationRecord::Phase phase;
+      std::chrono::steady_clock::time_point start;
+  };
+
+  // Bounded history of compilation records, persisted in a file, with a percentile report to catch regressions in build setup.
+  class CompilationHistory {
+    public:
+      inline void init(const std::wstring& path) { historyPath = path; }
+
+      // Add records, dropping the oldest ones if history is full, and save history to file
+      void add(const CompilationRecord& record);
+      void add(const std::vector<CompilationRecord>& newRecords);
+
+      // Text report of total time percentiles per game, per script and per error volume, along with median time of
+      // each phase, error parsing and compiler output throughput, and compiler's peak memory
+      std::wstring report();
+
+    private:
+      void load();
+      void save() const;
+
+      // Private members
+      //
+      std::mutex historyMutex;
+      std::wstring historyPath;
+      bool loaded {false};
+      std::deque<CompilationRecord> records;
+  };
+
+} // namespace
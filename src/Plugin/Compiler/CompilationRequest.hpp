@@ -23,16 +23,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "..\Common\NotepadPlusPlus.hpp"
 
 #include <string>
+#include <vector>
 
 namespace papyrus {
 
   using Game = game::Game;
 
+  struct ScriptFile {
+    npp_buffer_t bufferID {0};
+    std::wstring filePath;
+  };
+
   struct CompilationRequest {
     Game game {Game::Auto};
     npp_buffer_t bufferID {0};
     std::wstring filePath;
     bool useAutoModeOutputDirectory {false};
+    bool incremental {false}; // Build all scripts under the same source directory, only recompiling those that are out of date
+    bool project {false}; // File is a Papyrus project (.ppj), and all scripts listed in it are built
+    bool syntaxCheck {false}; // Only check syntax of buffer content, without generating outputs. Result is sent with PPM_SYNTAX_CHECK_DONE
+    std::string content; // Snapshot of buffer content to be checked, which may not have been saved
+    std::vector<ScriptFile> batchedFiles; // Other scripts in the same directory to be compiled along with this one
   };
 
 } // namespace
@@ -20,36 +20,92 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Compiler.hpp"
 
+#include "PapyrusProject.hpp"
+#include "PexAnonymizer.hpp"
+#include "PexOutputKeeper.hpp"
+
+#include "..\CompilationErrorHandling\CompilerErrorParser.hpp"
+#include "..\Common\FileSystemUtil.hpp"
 #include "..\Common\Logger.hpp"
 #include "..\Common\Resources.hpp"
 #include "..\Common\StringUtil.hpp"
+#include "..\Common\TextDecoder.hpp"
 #include "..\Lexer\Lexer.hpp"
 
 #include "..\..\external\gsl\include\gsl\util"
 #include "..\..\external\npp\Common.h"
 
+#include <algorithm>
+#include <chrono>
+#include <execution>
 #include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string_view>
 
 namespace papyrus {
 
   constexpr DWORD STDOUT_PIPE_SIZE = 10 * 1024 * 1024;  // Allow up to 10 MiB data to be returned from stdout
   constexpr DWORD STDERR_PIPE_SIZE = 500 * 1024 * 1024; // Allow up to 500 MiB data to be returned from stderr
+  constexpr DWORD PIPE_READ_BUFFER_SIZE = 64 * 1024;
+  constexpr DWORD PIPE_POLL_INTERVAL = 50;               // Milliseconds between reads of pipes while compiler is running, which also bounds cancellation latency
 
-  Compiler::Compiler(HWND messageWindow, const CompilerSettings& settings)
+  Compiler::Compiler(HWND messageWindow, const CompilerSettings& settings, const std::wstring& dataDirectory)
    : messageWindow(messageWindow), settings(settings) {
+    dependencyGraph.init(std::filesystem::path(dataDirectory) / PLUGIN_NAME L".deps");
+    outputCache.init(std::filesystem::path(dataDirectory) / PLUGIN_NAME L"Cache");
+    outputDeployer.init(std::filesystem::path(dataDirectory) / PLUGIN_NAME L"Deploy");
+    compilationHistory.init(std::filesystem::path(dataDirectory) / PLUGIN_NAME L".timings");
+  }
+
+  Compiler::Compiler(HWND messageWindow, const CompilerSettings& settings)
+    : messageWindow(messageWindow), settings(settings) {
+  }
+
+  Compiler::~Compiler() {
+    if (compilationThread.joinable()) {
+      if (isCompiling) {
+        // Worker could be blocked on sending its result to message window, which is handled by current thread.
+        compilationThread.detach();
+      } else {
+        compilationThread.join();
+      }
+    }
   }
 
   void Compiler::start(const CompilationRequest& request) {
     try {
-      if (!compilationThread.joinable()) {
-        compilationThread = std::thread([=]() { compile(request); }); // Capture the request by value due to asynchronous nature of thread
-      } else {
-        ::SendMessage(messageWindow, PPM_OTHER_ERROR, reinterpret_cast<WPARAM>(L"Compilation thread unusable."), reinterpret_cast<LPARAM>(L"Compilation aborted."));
+      if (compilationThread.joinable()) {
+        // Result of previous compilation has already been handled, so its worker is either done or about to return.
+        compilationThread.join();
       }
+      isCompiling = true;
+      isCancelled = false;
+      isErrorSent = false;
+      compilationThread = std::thread([=]() { compile(request); }); // Capture the request by value due to asynchronous nature of thread
     } catch (const std::system_error&) {
-      ::SendMessage(messageWindow, PPM_OTHER_ERROR, reinterpret_cast<WPARAM>(L"Starting compiler in thread failed."), reinterpret_cast<LPARAM>(L"Compilation stopped."));
+      isCompiling = false;
+      if (request.syntaxCheck) {
+        // Failed syntax check is reported as not completed, so that it's neither taken as failed compilation nor pops up an error
+        SyntaxCheckResult result {
+          .bufferID = request.bufferID,
+          .filePath = request.filePath
+        };
+        ::SendMessage(messageWindow, PPM_SYNTAX_CHECK_DONE, reinterpret_cast<WPARAM>(&result), 0);
+      } else {
+        ::SendMessage(messageWindow, PPM_OTHER_ERROR, reinterpret_cast<WPARAM>(L"Starting compiler in thread failed."), reinterpret_cast<LPARAM>(L"Compilation stopped."));
+      }
+    }
+  }
+
+  void Compiler::cancel() {
+    isCancelled = true;
+
+    std::lock_guard<std::mutex> lock(processMutex);
+    for (HANDLE job : compilerJobs) {
+      ::TerminateJobObject(job, 1);
     }
   }
 
@@ -57,8 +113,24 @@ namespace papyrus {
   //
 
   void Compiler::compile(CompilationRequest request) {
+    auto autoCleanup = gsl::finally([&] { isCompiling = false; });
+    isCheckingSyntax = request.syntaxCheck;
+    if (isCheckingSyntax) {
+      checkSyntax(request);
+      return;
+    }
+
     try {
+      compiledFiles.clear();
+      activeRecord = CompilationRecord {
+        .startTime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count(),
+        .game = request.game,
+        .filePath = request.filePath,
+        .scriptCount = 1 + request.batchedFiles.size()
+      };
+
       const CompilerSettings::GameSettings& gameSettings = settings.gameSettings(request.game);
+      outputCache.setMaxSize(static_cast<std::uint64_t>(settings.outputCacheSize) * 1024 * 1024);
       std::wstring path = gameSettings.compilerPath;
       if (std::ifstream(path).good()) {
         // Determine output file directory
@@ -78,108 +150,113 @@ namespace papyrus {
         for (size_t i = 0; i < scriptNameComponents.size(); ++i) {
           filePath = filePath.parent_path();
         }
-        LPCWSTR workingDirectory {filePath.c_str()};
-
-        // Define compiler process.
-        std::wstring commandLine =
-          L"\"" + path + L"\"" +
-          L" \"" + request.filePath + L"\"" +
-          L" -i=\"" + gameSettings.importDirectories + L"\"" +
-          L" -o=\"" + outputDirectory + L"\"" +
-          L" -f=\"" + gameSettings.flagFile + L"\"" +
-          (gameSettings.optimizeFlag ? L" -op" : L"") +
-          (gameSettings.releaseFlag ? L" -r" : L"") +
-          (gameSettings.finalFlag ? L" -final" : L"") +
-          L" " + gameSettings.additionalArguments;
-        STARTUPINFO startupInfo {
-          .dwFlags = STARTF_USESTDHANDLES
-        };
 
-        // Setup error output pipe.
-        HANDLE outputReadHandle {};
-        HANDLE errorReadHandle {};
-        SECURITY_ATTRIBUTES attr {};
-        attr.bInheritHandle = TRUE;
-        if (::CreatePipe(&outputReadHandle, &startupInfo.hStdOutput, &attr, STDOUT_PIPE_SIZE) && ::CreatePipe(&errorReadHandle, &startupInfo.hStdError, &attr, STDERR_PIPE_SIZE)) {
-          // Run the process.
-          PROCESS_INFORMATION compilationProcess {};
-          if (::CreateProcess(nullptr, const_cast<LPWSTR>(commandLine.c_str()), nullptr, nullptr, TRUE, CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT, nullptr, workingDirectory, &startupInfo, &compilationProcess)) {
-            if (::WaitForSingleObject(compilationProcess.hProcess, INFINITE) != WAIT_FAILED) {
-              DWORD size {};
-              if (::PeekNamedPipe(errorReadHandle, nullptr, 0, nullptr, &size, nullptr)) {
-                // Check if there are error reported by compiler on stderr.
-                if (size > 0) {
-                  // Read the error output from pipe.
-                  std::vector<char> data(size);
-                  if (::ReadFile(errorReadHandle, &data[0], size, nullptr, nullptr)) {
-                    std::wstring errorOutput(data.begin(), data.end());
-                    parseErrors(errorOutput, gameSettings, outputDirectory);
-                  } else {
-                    sendOtherErrorMessage(L"ReadFile failed. Compilation stopped.");
-                    closeProcess(compilationProcess, startupInfo);
-                    return;
-                  }
-                } else {
-                  // Check stdout as well. This is for the rare case that compilation passed but somehow the compiler chokes at .pas file, when optimize flag is used.
-                  if (::PeekNamedPipe(outputReadHandle, nullptr, 0, nullptr, &size, nullptr)) {
-                    bool hasError = false;
-                    if (size > 0) {
-                      std::vector<char> data(size);
-                      if (::ReadFile(outputReadHandle, &data[0], size, nullptr, nullptr)) {
-                        std::wstring stdOutput(data.begin(), data.end());
-                        if (stdOutput.find(L"compilation failed") != std::string::npos) {
-                          hasError = true;
-                          parseErrors(stdOutput, gameSettings, outputDirectory);
-                        }
-                      }
-                    }
-
-                    if (!hasError) {
-                      // No error, check if anonymization is needed.
-                      if (gameSettings.anonynmizeFlag) {
-                        // Output file has the same name as script name (relative path is determined by namepsace), with file extension set as ".pex".
-                        std::filesystem::path outputFile = std::filesystem::path(outputDirectory);
-                        for (const auto& scriptNameComponent : scriptNameComponents) {
-                          outputFile /= scriptNameComponent;
-                        }
-                        outputFile += ".pex";
-
-                        std::wstring errorMsg;
-                        if (anonymizeOutput(outputFile, errorMsg)) {
-                          ::SendMessage(messageWindow, PPM_COMPILATION_DONE, PARAM_COMPILATION_WITH_ANONYMIZATION, 0);
-                        } else {
-                          ::SendMessage(messageWindow, PPM_ANONYMIZATION_FAILED, reinterpret_cast<WPARAM>(&errorMsg), 0);
-                        }
-                      } else {
-                        ::SendMessage(messageWindow, PPM_COMPILATION_DONE, PARAM_COMPILATION_ONLY, 0);
-                      }
-                    }
-                  } else {
-                    sendOtherErrorMessage(L"PeekNamedPipe failed on stdout. Compilation stopped.");
-                    closeProcess(compilationProcess, startupInfo);
-                    return;
-                  }
+        if (request.project) {
+          buildProject(gameSettings, request.filePath);
+        } else if (request.incremental) {
+          build(gameSettings, filePath, outputDirectory, request.game == Game::Fallout4);
+        } else {
+          // Batched files are in the same directory, so they share the same namespace as well.
+          std::vector<BatchScript> scripts { BatchScript { .filePath = request.filePath, .scriptName = scriptName } };
+          for (const auto& batchedFile : request.batchedFiles) {
+            scripts.push_back(BatchScript {
+              .filePath = batchedFile.filePath,
+              .scriptName = Lexer::getScriptName(batchedFile.bufferID)
+            });
+          }
+          for (auto& script : scripts) {
+            if (script.scriptName.empty()) {
+              script.scriptName = std::filesystem::path(script.filePath).stem().string();
+            }
+            compiledFiles.push_back(script.filePath);
+          }
+
+          std::vector<DependencyGraph::ScriptInfo> scriptInfos;
+          utility::hash_t flagsHash = getFlagsHash(gameSettings, outputDirectory);
+          size_t skippedCount {0};
+          if (outputCache.isEnabled() || settings.skipTrivialChanges) {
+            PhaseTimer timer(activeRecord, CompilationRecord::Phase::Preparation);
+            for (const auto& script : scripts) {
+              scriptInfos.push_back(DependencyGraph::ScriptInfo {
+                .filePath = script.filePath,
+                .scriptName = script.scriptName
+              });
+            }
+            dependencyGraph.scan(filePath, getImportDirectories(gameSettings), request.game == Game::Fallout4, scriptInfos);
+
+            // Scripts with only comments or whitespace changed since last successful compilation would produce the same output.
+            if (settings.skipTrivialChanges) {
+              for (size_t i = scripts.size(); i-- > 0;) {
+                if (scriptInfos[i].sourceHash != 0 && dependencyGraph.isUpToDate(scriptInfos[i], flagsHash, outputDirectory, true)) {
+                  scripts.erase(scripts.begin() + i);
+                  scriptInfos.erase(scriptInfos.begin() + i);
+                  skippedCount++;
                 }
+              }
+            }
+          }
+          if (scripts.empty()) {
+            ::SendMessage(messageWindow, PPM_COMPILATION_DONE, PARAM_COMPILATION_ONLY | (std::min<size_t>(skippedCount, PARAM_SKIPPED_MASK) << PARAM_SKIPPED_SHIFT), 0);
+            return;
+          }
+
+          std::vector<Error> errors;
+          bool hasUnparsableLines = false;
+          size_t restoredCount {0};
+          PexOutputKeeper outputKeeper(getOutputFiles(scripts, outputDirectory, false));
+          RunResult result = runCached(gameSettings, scriptInfos, scripts, filePath, outputDirectory, errors, hasUnparsableLines, restoredCount);
+          if (result == RunResult::Aborted) {
+            return;
+          }
+          if (result == RunResult::Cancelled) {
+            ::SendMessage(messageWindow, PPM_COMPILATION_CANCELLED, 0, 0);
+            return;
+          }
+          if (result == RunResult::TimedOut) {
+            ::SendMessage(messageWindow, PPM_COMPILATION_TIMED_OUT, static_cast<WPARAM>(gameSettings.compilationTimeout), 0);
+            return;
+          }
+
+          // Check if anonymization is needed on scripts that are compiled.
+          std::wstring anonymizationErrorMsg;
+          if (gameSettings.anonynmizeFlag) {
+            PhaseTimer timer(activeRecord, CompilationRecord::Phase::Anonymization);
+            anonymizeOutputs(scripts, outputDirectory, anonymizationErrorMsg);
+          }
+          outputKeeper.keepUnchanged();
+
+          // Outputs are only deployed after they are anonymized, so personal information is never copied elsewhere.
+          std::wstring deploymentErrorMsg;
+          size_t deployedCount {0};
+          if (anonymizationErrorMsg.empty()) {
+            deployOutputs(gameSettings, scripts, outputDirectory, deployedCount, deploymentErrorMsg);
+          }
+
+          // Keep build records up to date, so unchanged scripts can be skipped by later compilations and incremental builds.
+          if (scriptInfos.size() == scripts.size()) {
+            for (size_t i = 0; i < scripts.size(); ++i) {
+              if (scripts[i].succeeded && anonymizationErrorMsg.empty() && scriptInfos[i].sourceHash != 0) {
+                dependencyGraph.markCompiled(scriptInfos[i], flagsHash);
               } else {
-                sendOtherErrorMessage(L"PeekNamedPipe failed on stderr. Compilation stopped.");
-                closeProcess(compilationProcess, startupInfo);
-                return;
+                dependencyGraph.markFailed(scriptInfos[i]);
               }
-            } else {
-              sendOtherErrorMessage(L"WaitForSingleObject failed. Compilation stopped.");
-              closeProcess(compilationProcess, startupInfo);
-              return;
             }
+            dependencyGraph.save();
+          }
 
-            // Always close child process handles.
-            closeProcess(compilationProcess, startupInfo);
+          if (result == RunResult::Failed) {
+            PhaseTimer timer(activeRecord, CompilationRecord::Phase::ErrorReporting);
+            ::SendMessage(messageWindow, PPM_COMPILATION_FAILED, reinterpret_cast<WPARAM>(&errors), hasUnparsableLines);
+          } else if (!anonymizationErrorMsg.empty()) {
+            ::SendMessage(messageWindow, PPM_ANONYMIZATION_FAILED, reinterpret_cast<WPARAM>(&anonymizationErrorMsg), 0);
+          } else if (!deploymentErrorMsg.empty()) {
+            ::SendMessage(messageWindow, PPM_DEPLOYMENT_FAILED, reinterpret_cast<WPARAM>(&deploymentErrorMsg), 0);
           } else {
-            sendOtherErrorMessage(L"CreateProcess failed. Compilation stopped.");
-            return;
+            WPARAM resultParam = (gameSettings.anonynmizeFlag ? PARAM_COMPILATION_WITH_ANONYMIZATION : PARAM_COMPILATION_ONLY) | (deployedCount > 0 ? PARAM_DEPLOYED : 0)
+              | (std::min<size_t>(skippedCount, PARAM_SKIPPED_MASK) << PARAM_SKIPPED_SHIFT) | (std::min<size_t>(restoredCount, PARAM_RESTORED_FROM_CACHE_MASK) << PARAM_RESTORED_FROM_CACHE_SHIFT);
+            ::SendMessage(messageWindow, PPM_COMPILATION_DONE, resultParam, static_cast<LPARAM>(scripts.size()));
           }
-        } else {
-          sendOtherErrorMessage(L"CreatePipe failed. Compilation stopped.");
-          return;
+          recordCompilation(result == RunResult::Succeeded && anonymizationErrorMsg.empty(), errors.size());
         }
       } else {
         ::SendMessage(messageWindow, PPM_COMPILER_NOT_FOUND, 0, 0);
@@ -188,158 +265,623 @@ namespace papyrus {
       // In case of any exception
       ::SendMessage(messageWindow, PPM_OTHER_ERROR, reinterpret_cast<WPARAM>(L"Running compiler in thread failed."), reinterpret_cast<LPARAM>(L"Compilation stopped."));
     }
-    compilationThread.detach();
   }
 
-  bool Compiler::anonymizeOutput(const std::wstring& outputFile, std::wstring& errorMsg) {
-    bool noError = true;
-    std::fstream file;
-    file.open(outputFile, std::ios::binary | std::ios::in | std::ios::out);
-    auto autoCleanup = gsl::finally([&] { file.close(); });
-
-    if (file.fail()) {
-      wchar_t errorMsgBuffer[512];
-      _wcserror_s(errorMsgBuffer, errno);
-      errorMsg = std::wstring(errorMsgBuffer);
-      noError = false;
-    } else {
-      // PEX file format (Skyrim & SSE in big endian, FO4 in little endian):
-      //   Signature:         4 bytes. Value: 0xDEC057FA (Skyrim & Skyrim SE) or 0xFA57C0DE (Fallout 4)
-      //   Major version:     1 byte.
-      //   Minor version:     1 byte.
-      //   Game ID:           2 bytes.
-      //   Compilation time:  8 bytes.
-      //   Script path size:  2 bytes.
-      //   Script path:       n bytes.
-      //   User name size:    2 bytes.
-      //   User name:         n bytes.
-      //   Host name size:    2 bytes.
-      //   Host name:         n bytes.
-      unsigned __int32 signature {};
-      file.read(reinterpret_cast<char *>(&signature), 4);
-      if (signature == 0xDEC057FA || signature == 0xFA57C0DE) {
-        bool isBigEndian = (signature == 0xDEC057FA);
-
-        // Skip to "Script path size".
-        file.seekg(16);
-
-        // Anonymize "Script path".
-        anonymizeCurrentField(file, isBigEndian);
-
-        // Anonymize "User name".
-        anonymizeCurrentField(file, isBigEndian);
-
-        // Anonymize "Host name".
-        anonymizeCurrentField(file, isBigEndian);
+  void Compiler::build(const GameSettings& gameSettings, const std::filesystem::path& sourceDirectory, const std::wstring& outputDirectory, bool supportNamespace) {
+    std::vector<std::wstring> importDirectories = getImportDirectories(gameSettings);
+    utility::hash_t flagsHash = getFlagsHash(gameSettings, outputDirectory);
+    std::vector<DependencyGraph::ScriptInfo> scripts;
+    {
+      PhaseTimer timer(activeRecord, CompilationRecord::Phase::Preparation);
+      scripts = dependencyGraph.plan(sourceDirectory, importDirectories, supportNamespace, outputDirectory, flagsHash, settings.skipTrivialChanges);
+    }
+    activeRecord.filePath = sourceDirectory.wstring();
+    activeRecord.scriptCount = scripts.size();
+
+    // Compiler resolves imported scripts from their sources, so outdated scripts don't need to be compiled one by one in dependency order.
+    std::vector<BatchScript> batchScripts;
+    for (const auto& script : scripts) {
+      batchScripts.push_back(BatchScript {
+        .filePath = script.filePath,
+        .scriptName = script.scriptName
+      });
+      compiledFiles.push_back(script.filePath);
+    }
+
+    std::vector<Error> errors;
+    bool hasUnparsableLines = false;
+    size_t restoredCount {0};
+    PexOutputKeeper outputKeeper(getOutputFiles(batchScripts, outputDirectory, false));
+    RunResult result = scripts.empty() ? RunResult::Succeeded : runCached(gameSettings, scripts, batchScripts, sourceDirectory, outputDirectory, errors, hasUnparsableLines, restoredCount);
+    if (result == RunResult::Aborted) {
+      return;
+    }
+    if (result == RunResult::Cancelled) {
+      ::SendMessage(messageWindow, PPM_COMPILATION_CANCELLED, 0, 0);
+      return;
+    }
+    if (result == RunResult::TimedOut) {
+      ::SendMessage(messageWindow, PPM_COMPILATION_TIMED_OUT, static_cast<WPARAM>(gameSettings.compilationTimeout), 0);
+      return;
+    }
+
+    std::wstring anonymizationErrorMsg;
+    if (gameSettings.anonynmizeFlag) {
+      PhaseTimer timer(activeRecord, CompilationRecord::Phase::Anonymization);
+      anonymizeOutputs(batchScripts, outputDirectory, anonymizationErrorMsg);
+    }
+    outputKeeper.keepUnchanged();
+
+    std::wstring deploymentErrorMsg;
+    size_t deployedCount {0};
+    if (anonymizationErrorMsg.empty()) {
+      deployOutputs(gameSettings, batchScripts, outputDirectory, deployedCount, deploymentErrorMsg);
+    }
+
+    // Outputs that failed to be anonymized are compiled again next time.
+    for (size_t i = 0; i < scripts.size(); ++i) {
+      if (batchScripts[i].succeeded && anonymizationErrorMsg.empty()) {
+        dependencyGraph.markCompiled(scripts[i], flagsHash);
       } else {
-        errorMsg = L"Unknown PEX file format: " + outputFile;
-        noError = false;
+        dependencyGraph.markFailed(scripts[i]);
       }
     }
+    dependencyGraph.save();
+
+    if (result == RunResult::Failed) {
+      PhaseTimer timer(activeRecord, CompilationRecord::Phase::ErrorReporting);
+      ::SendMessage(messageWindow, PPM_COMPILATION_FAILED, reinterpret_cast<WPARAM>(&errors), hasUnparsableLines);
+    } else if (!anonymizationErrorMsg.empty()) {
+      ::SendMessage(messageWindow, PPM_ANONYMIZATION_FAILED, reinterpret_cast<WPARAM>(&anonymizationErrorMsg), 0);
+    } else if (!deploymentErrorMsg.empty()) {
+      ::SendMessage(messageWindow, PPM_DEPLOYMENT_FAILED, reinterpret_cast<WPARAM>(&deploymentErrorMsg), 0);
+    } else {
+      WPARAM resultParam = PARAM_INCREMENTAL_BUILD | (gameSettings.anonynmizeFlag && !scripts.empty() ? PARAM_COMPILATION_WITH_ANONYMIZATION : PARAM_COMPILATION_ONLY)
+        | (deployedCount > 0 ? PARAM_DEPLOYED : 0) | (std::min<size_t>(restoredCount, PARAM_RESTORED_FROM_CACHE_MASK) << PARAM_RESTORED_FROM_CACHE_SHIFT);
+      ::SendMessage(messageWindow, PPM_COMPILATION_DONE, resultParam, static_cast<LPARAM>(scripts.size()));
+    }
+    recordCompilation(result == RunResult::Succeeded && anonymizationErrorMsg.empty(), errors.size());
+  }
+
+  void Compiler::checkSyntax(const CompilationRequest& request) {
+    SyntaxCheckResult result {
+      .bufferID = request.bufferID,
+      .filePath = request.filePath
+    };
+
+    try {
+      const GameSettings& gameSettings = settings.gameSettings(request.game);
+      if (std::ifstream(gameSettings.compilerPath).good()) {
+        auto scriptName = Lexer::getScriptName(request.bufferID);
+        if (scriptName.empty()) {
+          scriptName = std::filesystem::path(request.filePath).stem().string();
+        }
 
-    return noError;
+        // Compiler is still run from script's source directory, so flag file and other scripts are found in the same way.
+        std::filesystem::path sourceDirectory = std::filesystem::path(request.filePath);
+        for (size_t i = 0; i < utility::split(scriptName, ":").size(); ++i) {
+          sourceDirectory = sourceDirectory.parent_path();
+        }
+
+        // Snapshot is put in a scratch folder that goes before other import directories, in case compiler looks it up by script name.
+        std::filesystem::path scratchDirectory = std::filesystem::temp_directory_path() / PLUGIN_NAME / (L"check" + std::to_wstring(::GetCurrentProcessId()));
+        std::error_code errorCode;
+        std::filesystem::remove_all(scratchDirectory, errorCode);
+        auto autoCleanup = gsl::finally([&] { std::filesystem::remove_all(scratchDirectory, errorCode); });
+
+        std::filesystem::path snapshotDirectory = scratchDirectory / L"source";
+        std::filesystem::path snapshotFile = snapshotDirectory / DependencyGraph::getRelativePath(scriptName, L".psc");
+        std::filesystem::create_directories(snapshotFile.parent_path(), errorCode);
+        std::ofstream snapshot(snapshotFile, std::ios::binary | std::ios::trunc);
+        snapshot.write(request.content.data(), static_cast<std::streamsize>(request.content.size()));
+        snapshot.close();
+
+        std::vector<Error> errors;
+        bool hasUnparsableLines = false;
+        if (snapshot.good()) {
+          RunResult runResult = runCompiler(gameSettings, snapshotFile.wstring(), snapshotDirectory.wstring() + L";" + gameSettings.importDirectories, false, sourceDirectory.wstring(), (scratchDirectory / L"output").wstring(), errors, hasUnparsableLines, activeRecord);
+          if (!isInterrupted(runResult)) {
+            result.completed = true;
+            for (auto& error : errors) {
+              if (utility::compare(std::filesystem::path(error.file).lexically_normal().wstring(), snapshotFile.lexically_normal().wstring())) {
+                error.file = request.filePath;
+                result.errors.push_back(std::move(error));
+              }
+            }
+          }
+        }
+      }
+    } catch (...) {
+      // Failed check is simply not reported, as the next one will be started soon anyway
+    }
+    ::SendMessage(messageWindow, PPM_SYNTAX_CHECK_DONE, reinterpret_cast<WPARAM>(&result), 0);
   }
 
-  void Compiler::anonymizeCurrentField(std::fstream& file, bool isBigEndian) {
-    // First read current field's size.
-    int size = readSize(file, isBigEndian);
-    if (size > 0) {
-      // Switch to write mode.
-      file.seekp(file.tellg());
+  void Compiler::buildProject(const GameSettings& gameSettings, const std::wstring& projectFile) {
+    auto startTime = std::chrono::steady_clock::now();
+    PapyrusProject project;
+    std::wstring errorMsg;
+    if (!PapyrusProject::load(projectFile, project, errorMsg)) {
+      ::SendMessage(messageWindow, PPM_OTHER_ERROR, reinterpret_cast<WPARAM>(errorMsg.c_str()), reinterpret_cast<LPARAM>(L"Project build stopped."));
+      return;
+    }
+
+    // Settings specified in project take precedence over game settings.
+    GameSettings projectSettings;
+    projectSettings.compilerPath = gameSettings.compilerPath;
+    projectSettings.importDirectories = project.importDirectories.empty() ? gameSettings.importDirectories : project.importDirectories;
+    projectSettings.outputDirectory = project.outputDirectory.empty() ? gameSettings.outputDirectory : project.outputDirectory;
+    projectSettings.flagFile = project.flagFile.empty() ? gameSettings.flagFile : project.flagFile;
+    projectSettings.additionalArguments = gameSettings.additionalArguments;
+    projectSettings.anonynmizeFlag = gameSettings.anonynmizeFlag;
+    projectSettings.optimizeFlag = project.optimizeFlag.value_or(gameSettings.optimizeFlag);
+    projectSettings.releaseFlag = project.releaseFlag.value_or(gameSettings.releaseFlag);
+    projectSettings.finalFlag = project.finalFlag.value_or(gameSettings.finalFlag);
+    projectSettings.compilationTimeout = gameSettings.compilationTimeout;
+    projectSettings.deployDirectories = gameSettings.deployDirectories;
+
+    struct Job {
+      std::vector<Error> errors;
+      bool hasUnparsableLines {false};
+      RunResult result {RunResult::Succeeded};
+      CompilationRecord record;
+    };
+    std::vector<Job> jobs(project.scripts.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      jobs[i].record = CompilationRecord {
+        .startTime = activeRecord.startTime,
+        .game = activeRecord.game,
+        .filePath = project.scripts[i].target,
+        .scriptCount = 1
+      };
+    }
+
+    std::vector<BatchScript> scripts;
+    for (const auto& script : project.scripts) {
+      scripts.push_back(BatchScript {
+        .filePath = script.target,
+        .scriptName = script.scriptName
+      });
+
+      // Targets listed by script name or relative path are compiled from working directory.
+      std::filesystem::path sourceFile(script.target);
+      if (!sourceFile.is_absolute()) {
+        sourceFile = std::filesystem::path(script.workingDirectory) / DependencyGraph::getRelativePath(script.scriptName, L".psc");
+      }
+      compiledFiles.push_back(sourceFile.lexically_normal().wstring());
+    }
+    PexOutputKeeper outputKeeper(getOutputFiles(scripts, projectSettings.outputDirectory, false));
+
+    // Each job runs its own compiler process, so scripts are compiled in parallel across cores.
+    std::for_each(std::execution::par, jobs.begin(), jobs.end(),
+      [&](Job& job) {
+        const auto& script = project.scripts[&job - jobs.data()];
+        job.result = isCancelled ? RunResult::Cancelled : runCompiler(projectSettings, script.target, projectSettings.importDirectories, false, script.workingDirectory, projectSettings.outputDirectory, job.errors, job.hasUnparsableLines, job.record);
+        if (job.result == RunResult::Aborted) {
+          cancel(); // Error has been reported, so stop other jobs as well
+        }
+      }
+    );
+
+    // Merge results of all jobs, in the order scripts are listed in project.
+    RunResult result = RunResult::Succeeded;
+    std::vector<Error> errors;
+    bool hasUnparsableLines = false;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      Job& job = jobs[i];
+      result = std::max(result, job.result);
+      hasUnparsableLines = hasUnparsableLines || job.hasUnparsableLines;
+      errors.insert(errors.end(), std::make_move_iterator(job.errors.begin()), std::make_move_iterator(job.errors.end()));
+      scripts[i].succeeded = (job.result == RunResult::Succeeded);
+      job.record.succeeded = (job.result == RunResult::Succeeded);
+      job.record.errorCount = job.errors.size();
+    }
+    if (result == RunResult::Aborted) {
+      return;
+    }
+    if (result == RunResult::Cancelled) {
+      ::SendMessage(messageWindow, PPM_COMPILATION_CANCELLED, 0, 0);
+      return;
+    }
+    if (result == RunResult::TimedOut) {
+      ::SendMessage(messageWindow, PPM_COMPILATION_TIMED_OUT, static_cast<WPARAM>(gameSettings.compilationTimeout), 0);
+      return;
+    }
 
-      // Overwrite with dashes.
-      char* buffer = new char[size];
-      auto autoCleanup = gsl::finally([&] { delete[] buffer; });
-      memset(buffer, '-', size);
-      file.write(buffer, size);
+    std::wstring anonymizationErrorMsg;
+    if (projectSettings.anonynmizeFlag) {
+      anonymizeOutputs(scripts, projectSettings.outputDirectory, anonymizationErrorMsg);
+    }
+    outputKeeper.keepUnchanged();
 
-      // Switch back to read mode.
-      file.seekg(file.tellp());
+    std::wstring deploymentErrorMsg;
+    size_t deployedCount {0};
+    if (anonymizationErrorMsg.empty()) {
+      deployOutputs(projectSettings, scripts, projectSettings.outputDirectory, deployedCount, deploymentErrorMsg);
+    }
+
+    std::vector<CompilationRecord> records;
+    for (const auto& job : jobs) {
+      records.push_back(job.record);
+    }
+    try {
+      compilationHistory.add(records);
+    } catch (...) {
+      // Failing to record timing should not affect compilation result
+    }
+
+    if (result == RunResult::Failed) {
+      ::SendMessage(messageWindow, PPM_COMPILATION_FAILED, reinterpret_cast<WPARAM>(&errors), hasUnparsableLines);
+    } else if (!anonymizationErrorMsg.empty()) {
+      ::SendMessage(messageWindow, PPM_ANONYMIZATION_FAILED, reinterpret_cast<WPARAM>(&anonymizationErrorMsg), 0);
+    } else if (!deploymentErrorMsg.empty()) {
+      ::SendMessage(messageWindow, PPM_DEPLOYMENT_FAILED, reinterpret_cast<WPARAM>(&deploymentErrorMsg), 0);
+    } else {
+      ProjectBuildSummary summary {
+        .anonymized = projectSettings.anonynmizeFlag,
+        .deployedCount = deployedCount,
+        .elapsed = std::chrono::duration_cast<CompilationRecord::duration_t>(std::chrono::steady_clock::now() - startTime),
+        .jobs = std::move(records)
+      };
+      ::SendMessage(messageWindow, PPM_PROJECT_BUILD_DONE, reinterpret_cast<WPARAM>(&summary), 0);
     }
   }
 
-  int Compiler::readSize(std::fstream& file, bool isBigEndian) {
-    std::int16_t size {};
-    char* bytes = reinterpret_cast<char*>(&size);
-    file.read(bytes, 2);
+  Compiler::RunResult Compiler::runCached(const GameSettings& gameSettings, const std::vector<DependencyGraph::ScriptInfo>& scriptInfos, std::vector<BatchScript>& scripts, const std::wstring& workingDirectory, const std::wstring& outputDirectory, std::vector<Error>& errors, bool& hasUnparsableLines, size_t& restoredCount) {
+    if (!outputCache.isEnabled() || scriptInfos.size() != scripts.size()) {
+      return runBatch(gameSettings, scripts, workingDirectory, outputDirectory, errors, hasUnparsableLines);
+    }
 
-    if (isBigEndian)
-    {
-      std::swap(bytes[0], bytes[1]);
+    auto getOutputFile = [&](const BatchScript& script) { return (std::filesystem::path(outputDirectory) / DependencyGraph::getRelativePath(script.scriptName, L".pex")).wstring(); };
+    std::optional<PhaseTimer> preparationTimer;
+    preparationTimer.emplace(activeRecord, CompilationRecord::Phase::Preparation);
+    utility::hash_t environmentHash = getEnvironmentHash(gameSettings, workingDirectory, getImportDirectories(gameSettings));
+    std::vector<utility::hash_t> keys(scripts.size());
+    std::vector<BatchScript> pendingScripts;
+    std::vector<size_t> pendingIndices;
+    for (size_t i = 0; i < scripts.size(); ++i) {
+      if (scriptInfos[i].sourceHash != 0) {
+        keys[i] = utility::hashCombine(environmentHash, dependencyGraph.getContentHash(scriptInfos[i]));
+        if (outputCache.restore(keys[i], getOutputFile(scripts[i]))) {
+          scripts[i].succeeded = true;
+          restoredCount++;
+          continue;
+        }
+      }
+      pendingScripts.push_back(scripts[i]);
+      pendingIndices.push_back(i);
     }
-    return size;
+    preparationTimer.reset();
+
+    RunResult result = pendingScripts.empty() ? RunResult::Succeeded : runBatch(gameSettings, pendingScripts, workingDirectory, outputDirectory, errors, hasUnparsableLines);
+    preparationTimer.emplace(activeRecord, CompilationRecord::Phase::Preparation);
+    if (!isInterrupted(result)) {
+      for (size_t i = 0; i < pendingScripts.size(); ++i) {
+        BatchScript& script = scripts[pendingIndices[i]];
+        script.succeeded = pendingScripts[i].succeeded;
+        if (script.succeeded && keys[pendingIndices[i]] != 0) {
+          outputCache.store(keys[pendingIndices[i]], getOutputFile(script));
+        }
+      }
+    }
+    outputCache.save();
+    return result;
   }
 
-  void Compiler::parseErrors(const std::wstring& errorText, const CompilerSettings::GameSettings& gameSettings, const std::wstring& outputDirectory) {
-    bool hasUnparsableLines = false;
-    std::vector<Error> errors;
-    std::wstringstream output(errorText);
-    std::wstring line;
-    while (std::getline(output, line)) {
-      try {
-        std::wstring lineError = line;
-        Error error;
-        bool isScriptError = false;
-        if (utility::startsWith(lineError, L"<unknown>")) {
-          error.file = L"<unknown>";
-          lineError.erase(0, 10);
-        } else {
-          size_t fileExtIndex = utility::indexOf(lineError, L".psc(");
-          if (fileExtIndex == std::string::npos && gameSettings.optimizeFlag) {
-            fileExtIndex = utility::indexOf(lineError, L".pas(");
-            isScriptError = true;
-          }
+  Compiler::RunResult Compiler::runBatch(const GameSettings& gameSettings, std::vector<BatchScript>& scripts, const std::wstring& workingDirectory, const std::wstring& outputDirectory, std::vector<Error>& errors, bool& hasUnparsableLines) {
+    auto compileOneByOne = [&]() {
+      RunResult batchResult = RunResult::Succeeded;
+      for (auto& script : scripts) {
+        RunResult result = runCompiler(gameSettings, script.filePath, gameSettings.importDirectories, false, workingDirectory, outputDirectory, errors, hasUnparsableLines, activeRecord);
+        if (isInterrupted(result)) {
+          return result;
+        }
+        script.succeeded = (result == RunResult::Succeeded);
+        if (!script.succeeded) {
+          batchResult = RunResult::Failed;
+        }
+      }
+      return batchResult;
+    };
 
-          if (fileExtIndex != std::string::npos) {
-            error.file = lineError.substr(0, fileExtIndex + 4);
-            if (isScriptError) {
-              error.file = std::filesystem::path(outputDirectory) / error.file; // Papyrus compiler doesn't provide full path for .pas files
-            }
-            lineError.erase(0, fileExtIndex + 5);
+    if (scripts.size() == 1) {
+      return compileOneByOne();
+    }
+
+    // PapyrusCompiler can only compile all scripts in a folder ("-all"), which may contain scripts that don't need to be compiled.
+    // So link the scripts into a staging folder, which goes before other import directories so staged scripts are compiled.
+    // Scripts with the same namespace are put in the same subfolder, as "-all" doesn't look into subfolders.
+    std::filesystem::path stagingDirectory = std::filesystem::temp_directory_path() / PLUGIN_NAME / (L"batch" + std::to_wstring(::GetCurrentProcessId()));
+    std::error_code errorCode;
+    std::filesystem::remove_all(stagingDirectory, errorCode);
+    auto autoCleanup = gsl::finally([&] { std::filesystem::remove_all(stagingDirectory, errorCode); });
+
+    std::map<std::wstring, std::vector<size_t>> namespaceScripts; // Keyed by staging subfolder
+    std::map<std::wstring, size_t> stagedFiles; // Keyed by upper case paths of staged scripts and their assembly files, in case optimize flag is used
+    for (size_t i = 0; i < scripts.size(); ++i) {
+      std::filesystem::path relativePath = DependencyGraph::getRelativePath(scripts[i].scriptName, L".psc");
+      std::filesystem::path stagedFile = stagingDirectory / relativePath;
+      std::filesystem::create_directories(stagedFile.parent_path(), errorCode);
+      if (!::CreateHardLink(stagedFile.c_str(), scripts[i].filePath.c_str(), nullptr) && !::CopyFile(scripts[i].filePath.c_str(), stagedFile.c_str(), FALSE)) {
+        return compileOneByOne();
+      }
+
+      namespaceScripts[stagedFile.parent_path()].push_back(i);
+      stagedFiles[utility::toUpper(stagedFile.wstring())] = i;
+      stagedFiles[utility::toUpper((std::filesystem::path(outputDirectory) / relativePath.replace_extension(L".pas")).wstring())] = i;
+    }
+
+    RunResult batchResult = RunResult::Succeeded;
+    std::wstring importDirectories = stagingDirectory.wstring() + L";" + gameSettings.importDirectories;
+    for (const auto& [folder, indices] : namespaceScripts) {
+      size_t previousErrorCount = errors.size();
+      RunResult result = runCompiler(gameSettings, folder, importDirectories, true, workingDirectory, outputDirectory, errors, hasUnparsableLines, activeRecord);
+      if (isInterrupted(result)) {
+        return result;
+      }
+
+      // Split combined errors back to each script, and report them against the original files.
+      std::set<size_t> failedScripts;
+      for (auto iter = errors.begin() + previousErrorCount; iter != errors.end(); ++iter) {
+        auto stagedFile = stagedFiles.find(utility::toUpper(iter->file));
+        if (stagedFile != stagedFiles.end()) {
+          if (utility::endsWith(iter->file, L".psc")) {
+            iter->file = scripts[stagedFile->second].filePath;
           }
+          failedScripts.insert(stagedFile->second);
         }
+      }
 
-        if (!error.file.empty()) {
-          if (!isScriptError) { // .psc
-            size_t indexComma = lineError.find_first_of(L',');
-            error.line = std::stoi(lineError.substr(0, indexComma));
-
-            size_t indexParenthesis = lineError.find_first_of(L')');
-            error.column = std::stoi(lineError.substr(indexComma + 1, indexParenthesis - (indexComma - 1)));
-            error.message = lineError.substr(indexParenthesis + 3);
-          } else { // .pas
-            size_t indexParenthesis = lineError.find_first_of(L')');
-            error.line = std::stoi(lineError.substr(0, indexParenthesis));
-            error.column = 1; // Papyrus compiler doesn't provide column info for .pas files
-            error.message = lineError.substr(indexParenthesis + 4);
-          }
+      for (size_t index : indices) {
+        // If none of the errors belongs to a specific script, consider all of them failed.
+        scripts[index].succeeded = (result == RunResult::Succeeded) || (!failedScripts.empty() && !failedScripts.contains(index));
+        if (!scripts[index].succeeded) {
+          batchResult = RunResult::Failed;
+        }
+      }
+    }
+    return batchResult;
+  }
 
-          // Discard duplicate errors.
-          auto iter = std::find_if(errors.begin(), errors.end(),
-            [&](const auto& comparisionError) {
-              return comparisionError.file == error.file
-                && comparisionError.message == error.message
-                && comparisionError.line == error.line
-                && comparisionError.column == error.column;
-            }
-          );
-          if (iter == errors.end()) {
-            errors.push_back(error);
-          }
+  Compiler::RunResult Compiler::runCompiler(const GameSettings& gameSettings, const std::wstring& target, const std::wstring& importDirectories, bool compileAll, const std::wstring& workingDirectory, const std::wstring& outputDirectory, std::vector<Error>& errors, bool& hasUnparsableLines, CompilationRecord& record) {
+    std::optional<PhaseTimer> startupTimer;
+    startupTimer.emplace(record, CompilationRecord::Phase::ProcessStartup);
+
+    // Define compiler process.
+    std::wstring commandLine =
+      L"\"" + gameSettings.compilerPath + L"\"" +
+      L" \"" + target + L"\"" +
+      (compileAll ? L" -all" : L"") +
+      L" -i=\"" + importDirectories + L"\"" +
+      L" -o=\"" + outputDirectory + L"\"" +
+      L" -f=\"" + gameSettings.flagFile + L"\"" +
+      (gameSettings.optimizeFlag ? L" -op" : L"") +
+      (gameSettings.releaseFlag ? L" -r" : L"") +
+      (gameSettings.finalFlag ? L" -final" : L"") +
+      L" " + gameSettings.additionalArguments;
+    STARTUPINFO startupInfo {
+      .dwFlags = STARTF_USESTDHANDLES
+    };
+
+    // Setup error output pipe.
+    HANDLE outputReadHandle {};
+    HANDLE errorReadHandle {};
+    SECURITY_ATTRIBUTES attr {};
+    attr.bInheritHandle = TRUE;
+    if (!::CreatePipe(&outputReadHandle, &startupInfo.hStdOutput, &attr, STDOUT_PIPE_SIZE) || !::CreatePipe(&errorReadHandle, &startupInfo.hStdError, &attr, STDERR_PIPE_SIZE)) {
+      sendOtherErrorMessage(L"CreatePipe failed. Compilation stopped.");
+      return RunResult::Aborted;
+    }
+
+    // Run the process in a job, so the whole process tree can be terminated when cancelled or timed out. Closing the job
+    // handle kills any process left in it, e.g. a child of the compiler that is still holding pipes open.
+    HANDLE job = ::CreateJobObject(nullptr, nullptr);
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION jobLimit {
+      .BasicLimitInformation {
+        .LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE
+      }
+    };
+    if (!job || !::SetInformationJobObject(job, JobObjectExtendedLimitInformation, &jobLimit, sizeof(jobLimit))) {
+      if (job) {
+        ::CloseHandle(job);
+      }
+      sendOtherErrorMessage(L"CreateJobObject failed. Compilation stopped.");
+      return RunResult::Aborted;
+    }
+
+    // Process is started suspended, so it can't create any child process before it has been assigned to the job.
+    PROCESS_INFORMATION compilationProcess {};
+    if (!::CreateProcess(nullptr, const_cast<LPWSTR>(commandLine.c_str()), nullptr, nullptr, TRUE, CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT | CREATE_SUSPENDED | (isCheckingSyntax ? BELOW_NORMAL_PRIORITY_CLASS : 0), nullptr, workingDirectory.c_str(), &startupInfo, &compilationProcess)) {
+      ::CloseHandle(job);
+      sendOtherErrorMessage(L"CreateProcess failed. Compilation stopped.");
+      return RunResult::Aborted;
+    }
+
+    // Always close child process handles.
+    auto autoCleanup = gsl::finally([&] {
+      std::lock_guard<std::mutex> lock(processMutex);
+      std::erase(compilerJobs, job);
+      ::CloseHandle(job);
+      closeProcess(compilationProcess, startupInfo);
+      ::CloseHandle(outputReadHandle);
+      ::CloseHandle(errorReadHandle);
+    });
+
+    if (!::AssignProcessToJobObject(job, compilationProcess.hProcess)) {
+      ::TerminateProcess(compilationProcess.hProcess, 1);
+      sendOtherErrorMessage(L"AssignProcessToJobObject failed. Compilation stopped.");
+      return RunResult::Aborted;
+    }
+
+    {
+      // Make the job visible to cancel(), which could have been called before it was created.
+      std::lock_guard<std::mutex> lock(processMutex);
+      compilerJobs.push_back(job);
+      if (isCancelled) {
+        ::TerminateJobObject(job, 1);
+      }
+    }
+    ::ResumeThread(compilationProcess.hThread);
+    startupTimer.reset();
+
+    // Keep draining pipes while the process is running, so output is decoded as it arrives.
+    std::vector<char> buffer(PIPE_READ_BUFFER_SIZE);
+    auto drainPipe = [&](HANDLE pipe, utility::TextDecoder& decoder, std::wstring& text) {
+      PhaseTimer timer(record, CompilationRecord::Phase::PipeRead);
+      DWORD size {};
+      while (::PeekNamedPipe(pipe, nullptr, 0, nullptr, &size, nullptr)) {
+        if (size == 0) {
+          return true;
         }
-      } catch (...) {
-        //log(line);
-        hasUnparsableLines = true;
+
+        DWORD bytesRead {};
+        if (!::ReadFile(pipe, buffer.data(), std::min(size, static_cast<DWORD>(buffer.size())), &bytesRead, nullptr)) {
+          return false;
+        }
+        decoder.decode(std::string_view(buffer.data(), bytesRead), text);
+        record.outputBytes += bytesRead;
+      }
+      return false;
+    };
+
+    utility::TextDecoder errorDecoder;
+    utility::TextDecoder outputDecoder;
+    std::wstring errorOutput;
+    std::wstring stdOutput;
+    bool isTimedOut = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(gameSettings.compilationTimeout);
+    for (bool isRunning = true; isRunning;) {
+      DWORD waitResult {};
+      {
+        PhaseTimer timer(record, CompilationRecord::Phase::Compiler);
+        waitResult = ::WaitForSingleObject(compilationProcess.hProcess, PIPE_POLL_INTERVAL);
+      }
+      if (waitResult == WAIT_FAILED) {
+        sendOtherErrorMessage(L"WaitForSingleObject failed. Compilation stopped.");
+        return RunResult::Aborted;
+      }
+      isRunning = (waitResult == WAIT_TIMEOUT);
+      if (isRunning && !isTimedOut && gameSettings.compilationTimeout > 0 && std::chrono::steady_clock::now() >= deadline) {
+        // Keep draining pipes until the terminated process is gone, so it is not blocked on writing to them.
+        isTimedOut = true;
+        ::TerminateJobObject(job, 1);
+      }
+
+      if (!drainPipe(errorReadHandle, errorDecoder, errorOutput)) {
+        sendOtherErrorMessage(L"Reading stderr failed. Compilation stopped.");
+        return RunResult::Aborted;
+      }
+      if (!drainPipe(outputReadHandle, outputDecoder, stdOutput)) {
+        sendOtherErrorMessage(L"Reading stdout failed. Compilation stopped.");
+        return RunResult::Aborted;
       }
     }
+    errorDecoder.finish(errorOutput);
+    outputDecoder.finish(stdOutput);
 
-    if (errors.empty()) {
-      // In the rare case when error cannot be parsed (likely some errors dumped on stdout that are not related to specific files), send the whole output to error window.
-      errors.push_back(Error {
-        .message = errorText
-      });
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION jobInfo {};
+    if (::QueryInformationJobObject(job, JobObjectExtendedLimitInformation, &jobInfo, sizeof(jobInfo), nullptr)) {
+      record.peakMemory = std::max<std::uint64_t>(record.peakMemory, jobInfo.PeakJobMemoryUsed);
+    }
+    PhaseTimer parsingTimer(record, CompilationRecord::Phase::ErrorParsing);
+
+    if (isCancelled) {
+      return RunResult::Cancelled;
+    }
+    if (isTimedOut) {
+      return RunResult::TimedOut;
+    }
+
+    // Check if there are error reported by compiler on stderr.
+    if (!errorOutput.empty()) {
+      hasUnparsableLines = CompilerErrorParser::parse(errorOutput, gameSettings.optimizeFlag, outputDirectory, errors) || hasUnparsableLines;
+      return RunResult::Failed;
+    }
+
+    // Check stdout as well. This is for the rare case that compilation passed but somehow the compiler chokes at .pas file, when optimize flag is used.
+    if (stdOutput.find(L"compilation failed") != std::wstring::npos) {
+      hasUnparsableLines = CompilerErrorParser::parse(stdOutput, gameSettings.optimizeFlag, outputDirectory, errors) || hasUnparsableLines;
+      return RunResult::Failed;
+    }
+
+    return RunResult::Succeeded;
+  }
+
+  utility::hash_t Compiler::getFlagsHash(const GameSettings& gameSettings, const std::wstring& outputDirectory) const {
+    utility::hash_t flagsHash = utility::hash(utility::toUpper(gameSettings.flagFile));
+    flagsHash = utility::hash(utility::toUpper(outputDirectory), flagsHash);
+    flagsHash = utility::hash(gameSettings.additionalArguments, flagsHash);
+    bool flags[] { gameSettings.optimizeFlag, gameSettings.releaseFlag, gameSettings.finalFlag };
+    return utility::hash(flags, sizeof(flags), flagsHash);
+  }
+
+  utility::hash_t Compiler::getEnvironmentHash(const GameSettings& gameSettings, const std::wstring& workingDirectory, const std::vector<std::wstring>& importDirectories) const {
+    utility::hash_t compilerHash {0};
+    utility::hashFile(gameSettings.compilerPath, compilerHash);
+
+    // Flag file is searched in the same way as imported scripts, unless it is an absolute path.
+    utility::hash_t flagFileHash = utility::hash(utility::toUpper(gameSettings.flagFile));
+    std::vector<std::filesystem::path> flagFileCandidates { gameSettings.flagFile };
+    if (!flagFileCandidates.front().is_absolute()) {
+      flagFileCandidates.front() = std::filesystem::path(workingDirectory) / gameSettings.flagFile;
+      for (const auto& importDirectory : importDirectories) {
+        flagFileCandidates.push_back(std::filesystem::path(importDirectory) / gameSettings.flagFile);
+      }
+    }
+    for (const auto& flagFile : flagFileCandidates) {
+      if (utility::fileExists(flagFile.wstring()) && utility::hashFile(flagFile.wstring(), flagFileHash)) {
+        break;
+      }
+    }
+
+    utility::hash_t environmentHash = utility::hashCombine(compilerHash, flagFileHash);
+    environmentHash = utility::hash(gameSettings.additionalArguments, environmentHash);
+    bool flags[] { gameSettings.optimizeFlag, gameSettings.releaseFlag, gameSettings.finalFlag };
+    return utility::hash(flags, sizeof(flags), environmentHash);
+  }
+
+  std::vector<std::wstring> Compiler::getImportDirectories(const GameSettings& gameSettings) {
+    std::vector<std::wstring> importDirectories = utility::split(gameSettings.importDirectories, L";");
+    std::erase_if(importDirectories, [](const auto& importDirectory) { return importDirectory.empty(); });
+    return importDirectories;
+  }
+
+  std::vector<std::wstring> Compiler::getOutputFiles(const std::vector<BatchScript>& scripts, const std::wstring& outputDirectory, bool succeededOnly) {
+    // Output file has the same name as script name (relative path is determined by namepsace), with file extension set as ".pex".
+    std::vector<std::wstring> outputFiles;
+    for (const auto& script : scripts) {
+      if (script.succeeded || !succeededOnly) {
+        outputFiles.push_back(std::filesystem::path(outputDirectory) / DependencyGraph::getRelativePath(script.scriptName, L".pex"));
+      }
+    }
+    return outputFiles;
+  }
+
+  bool Compiler::anonymizeOutputs(const std::vector<BatchScript>& scripts, const std::wstring& outputDirectory, std::wstring& errorMsg) {
+    return PexAnonymizer::anonymize(getOutputFiles(scripts, outputDirectory, true), errorMsg);
+  }
+
+  bool Compiler::deployOutputs(const GameSettings& gameSettings, const std::vector<BatchScript>& scripts, const std::wstring& outputDirectory, size_t& deployedCount, std::wstring& errorMsg) {
+    std::vector<std::wstring> deployDirectories = utility::split(gameSettings.deployDirectories, L";");
+    std::erase_if(deployDirectories, [](const auto& deployDirectory) { return deployDirectory.empty(); });
+
+    std::vector<std::wstring> relativePaths;
+    for (const auto& script : scripts) {
+      if (script.succeeded) {
+        relativePaths.push_back(DependencyGraph::getRelativePath(script.scriptName, L".pex"));
+      }
+    }
+    return outputDeployer.deploy(outputDirectory, relativePaths, deployDirectories, deployedCount, errorMsg);
+  }
+
+  void Compiler::recordCompilation(bool succeeded, size_t errorCount) {
+    activeRecord.succeeded = succeeded;
+    activeRecord.errorCount = errorCount;
+    try {
+      compilationHistory.add(activeRecord);
+    } catch (...) {
+      // Failing to record timing should not affect compilation result, which has already been reported
     }
-    ::SendMessage(messageWindow, PPM_COMPILATION_FAILED, reinterpret_cast<WPARAM>(&errors), hasUnparsableLines);
   }
 
   void Compiler::closeProcess(const PROCESS_INFORMATION& processInfo, const STARTUPINFO& startupInfo) {
@@ -353,6 +895,11 @@ namespace papyrus {
   }
 
   void Compiler::sendOtherErrorMessage(const wchar_t* msg) {
+    // Background syntax check fails silently, as it would otherwise keep popping up the same error while user is typing
+    if (isCheckingSyntax || isErrorSent.exchange(true)) {
+      return;
+    }
+
     std::wstring errorMsg(L"Error code: " + std::to_wstring(::GetLastError()));
     ::SendMessage(messageWindow, PPM_OTHER_ERROR, reinterpret_cast<WPARAM>(errorMsg.c_str()), reinterpret_cast<LPARAM>(msg));
   }
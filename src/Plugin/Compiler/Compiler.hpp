@@ -20,11 +20,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include "CompilationHistory.hpp"
 #include "CompilationRequest.hpp"
 #include "CompilerSettings.hpp"
+#include "DependencyGraph.hpp"
+#include "OutputCache.hpp"
+#include "OutputDeployer.hpp"
 
 #include "..\CompilationErrorHandling\Error.hpp"
 
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -34,37 +43,134 @@ namespace papyrus {
 
   class Compiler {
     public:
+      Compiler(HWND messageWindow, const CompilerSettings& settings, const std::wstring& dataDirectory);
+
+      // Compiler without persistent state, i.e. dependency graph, output cache, deploy manifests and timing history,
+      // for background syntax checks that would otherwise overwrite those files of the main compiler
       Compiler(HWND messageWindow, const CompilerSettings& settings);
+      ~Compiler();
 
+      // Start compilation in worker thread. Exactly one result message is sent to message window for each
+      // started request, and caller must not start another one before that message has been handled.
       void start(const CompilationRequest& request);
 
+      // Stop active compilation by terminating running compiler process and all its child processes.
+      // PPM_COMPILATION_CANCELLED will be sent unless compilation has already finished
+      void cancel();
+
+      inline OutputCache& getOutputCache() { return outputCache; }
+      inline CompilationHistory& getCompilationHistory() { return compilationHistory; }
+
+      // Source files compiled by active compilation, whose errors are all reported by its result message.
+      // Only valid while that message is handled, as worker thread is waiting for it meanwhile
+      inline const std::vector<std::wstring>& getCompiledFiles() const { return compiledFiles; }
+
+      // Result of a successful project build, passed with PPM_PROJECT_BUILD_DONE
+      struct ProjectBuildSummary {
+        bool anonymized {false};
+        size_t deployedCount {0}; // Number of files copied to deploy directories
+        CompilationRecord::duration_t elapsed {};
+        std::vector<CompilationRecord> jobs; // One per script, in the order listed in project
+      };
+
+      // Result of a background syntax check, passed with PPM_SYNTAX_CHECK_DONE
+      struct SyntaxCheckResult {
+        npp_buffer_t bufferID {0};
+        std::wstring filePath;
+        bool completed {false}; // False if check was cancelled, or compiler could not be run
+        std::vector<Error> errors; // Only errors of the checked script, with lines of the snapshot
+      };
+
     private:
+      using GameSettings = CompilerSettings::GameSettings;
+
+      struct BatchScript {
+        std::wstring filePath;
+        std::string scriptName;
+        bool succeeded {false};
+      };
+
+      // Ordered by severity, so combined result of parallel runs is the most severe one
+      enum class RunResult {
+        Succeeded,
+        Failed,
+        Cancelled,
+        TimedOut, // Compiler process ran longer than game's compilation timeout and was terminated
+        Aborted   // Compiler process could not be run properly, and an error message has already been sent
+      };
+
+      // Whether compilation should stop without reporting results of scripts
+      static inline bool isInterrupted(RunResult result) noexcept { return result == RunResult::Cancelled || result == RunResult::TimedOut || result == RunResult::Aborted; }
+
       // Compile the given script file in a separate thread
       void compile(CompilationRequest request);
 
-      // Anonymize generated PEX script
-      bool anonymizeOutput(const std::wstring& outputFile, std::wstring& errorMsg);
+      // Build all scripts under source directory incrementally, only recompiling those that are out of date
+      void build(const GameSettings& gameSettings, const std::filesystem::path& sourceDirectory, const std::wstring& outputDirectory, bool supportNamespace);
+
+      // Compile buffer content snapshot of a script into a scratch directory, so compiler's diagnostics are available before it is saved.
+      // Compiler runs at low priority, and outputs are thrown away
+      void checkSyntax(const CompilationRequest& request);
+
+      // Build all scripts listed in a Papyrus project file, running one compiler process per script in parallel
+      void buildProject(const GameSettings& gameSettings, const std::wstring& projectFile);
+
+      // Restore outputs of scripts from cache when possible, and compile the rest in a batch. Outputs of newly compiled scripts are added
+      // to cache. Script information is needed to find cached outputs, so cache is skipped if it is not provided for each script
+      RunResult runCached(const GameSettings& gameSettings, const std::vector<DependencyGraph::ScriptInfo>& scriptInfos, std::vector<BatchScript>& scripts, const std::wstring& workingDirectory, const std::wstring& outputDirectory, std::vector<Error>& errors, bool& hasUnparsableLines, size_t& restoredCount);
+
+      // Compile multiple scripts with as few compiler invocations as possible, to save the compiler's startup time on each script.
+      // Result of each script is set in the list. Returns Failed if any script fails to compile.
+      RunResult runBatch(const GameSettings& gameSettings, std::vector<BatchScript>& scripts, const std::wstring& workingDirectory, const std::wstring& outputDirectory, std::vector<Error>& errors, bool& hasUnparsableLines);
+
+      // Run compiler process on a script file, or all scripts in a folder if "compileAll" is true. Compilation errors, if any, are appended to the given list.
+      // Time spent is added to the given record. Multiple compiler processes can be run in parallel
+      RunResult runCompiler(const GameSettings& gameSettings, const std::wstring& target, const std::wstring& importDirectories, bool compileAll, const std::wstring& workingDirectory, const std::wstring& outputDirectory, std::vector<Error>& errors, bool& hasUnparsableLines, CompilationRecord& record);
+
+      // Hash of compiler flags that affect generated PEX scripts
+      utility::hash_t getFlagsHash(const GameSettings& gameSettings, const std::wstring& outputDirectory) const;
+
+      // Hash of everything other than scripts that affects generated PEX scripts, i.e. compiler binary, flag file content and compiler flags
+      utility::hash_t getEnvironmentHash(const GameSettings& gameSettings, const std::wstring& workingDirectory, const std::vector<std::wstring>& importDirectories) const;
+
+      static std::vector<std::wstring> getImportDirectories(const GameSettings& gameSettings);
+
+      // Paths of generated PEX files of scripts, optionally only those that are successfully compiled
+      static std::vector<std::wstring> getOutputFiles(const std::vector<BatchScript>& scripts, const std::wstring& outputDirectory, bool succeededOnly);
 
-      // Anonymize a field that is at current location. This feild can be "Script path", or "User name", or "Host name"
-      void anonymizeCurrentField(std::fstream& file, bool isBigEndian);
+      // Anonymize generated PEX files of scripts that are successfully compiled
+      bool anonymizeOutputs(const std::vector<BatchScript>& scripts, const std::wstring& outputDirectory, std::wstring& errorMsg);
 
-      // Read size of a field from PEX header. Skyrim & SSE use big endian, FO4 uses little endian
-      int readSize(std::fstream& file, bool isBigEndian);
+      // Copy changed outputs of scripts that are successfully compiled to game's deploy directories
+      bool deployOutputs(const GameSettings& gameSettings, const std::vector<BatchScript>& scripts, const std::wstring& outputDirectory, size_t& deployedCount, std::wstring& errorMsg);
 
-      // Parse compilation errors and send the result back to plugin message window
-      void parseErrors(const std::wstring& errorText, const CompilerSettings::GameSettings& gameSettings, const std::wstring& outputDirectory);
+      // Add timing record of active compilation to history
+      void recordCompilation(bool succeeded, size_t errorCount);
 
       // Close compilation process
       void closeProcess(const PROCESS_INFORMATION& processInfo, const STARTUPINFO& startupInfo);
 
-      // Send any unexpected "other error message" to plugin main processor, along with last error code from Win32 API
+      // Send any unexpected "other error message" to plugin main processor, along with last error code from Win32 API.
+      // Only the first one of a compilation is sent, as parallel compiler runs could fail for the same reason
       void sendOtherErrorMessage(const wchar_t* msg);
 
       // Private members
       //
       const HWND messageWindow;
       const CompilerSettings& settings;
-      std::thread compilationThread;
+      std::thread compilationThread; // Owned by this object. A finished worker is joined when next one starts, or on destruction
+      std::atomic_bool isCompiling {false};
+      std::atomic_bool isCancelled {false};
+      std::atomic_bool isErrorSent {false};
+      std::mutex processMutex;
+      std::vector<HANDLE> compilerJobs; // Job objects of running compiler processes, guarded by processMutex
+      DependencyGraph dependencyGraph;
+      OutputCache outputCache;
+      OutputDeployer outputDeployer;
+      CompilationHistory compilationHistory;
+      CompilationRecord activeRecord; // Only accessed by worker thread
+      std::vector<std::wstring> compiledFiles; // Written by worker thread before result message is sent
+      bool isCheckingSyntax {false}; // Only accessed by worker thread
   };
 
 } // namespace
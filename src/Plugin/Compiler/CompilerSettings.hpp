@@ -32,6 +32,9 @@ namespace papyrus {
 
   using Game = game::Game;
 
+  constexpr int DEFAULT_OUTPUT_CACHE_SIZE = 256; // In MiB
+  constexpr int DEFAULT_COMPILATION_TIMEOUT = 120; // In seconds
+
   struct CompilerSettings {
 
     struct GameSettings {
@@ -42,10 +45,12 @@ namespace papyrus {
       std::wstring outputDirectory;
       std::wstring flagFile;
       std::wstring additionalArguments;
+      std::wstring deployDirectories; // Semicolon separated directories that compiled outputs are copied to
       utility::PrimitiveTypeValueMonitor<bool> anonynmizeFlag;
       utility::PrimitiveTypeValueMonitor<bool> optimizeFlag;
       utility::PrimitiveTypeValueMonitor<bool> releaseFlag;
       utility::PrimitiveTypeValueMonitor<bool> finalFlag;
+      utility::PrimitiveTypeValueMonitor<int> compilationTimeout; // In seconds, 0 means no timeout
     };
 
     GameSettings skyrim;
@@ -55,6 +60,11 @@ namespace papyrus {
     Game autoModeDefaultGame {Game::Auto};
     std::wstring autoModeOutputDirectory;
     utility::PrimitiveTypeValueMonitor<bool> allowUnmanagedSource;
+    utility::PrimitiveTypeValueMonitor<bool> compileOnSave;
+    utility::PrimitiveTypeValueMonitor<bool> skipTrivialChanges; // Skip scripts with only comments or whitespace changed since last successful compilation
+    utility::PrimitiveTypeValueMonitor<bool> checkSyntaxInBackground; // Run compiler on unsaved content after user stops typing, and annotate errors
+    utility::PrimitiveTypeValueMonitor<bool> monitorRuntimeLog; // Watch enabled games' Papyrus logs, and show runtime errors on script sources
+    utility::PrimitiveTypeValueMonitor<int> outputCacheSize; // In MiB, 0 means disabled
 
     const GameSettings& gameSettings(Game game) const;
     GameSettings& gameSettings(Game game);
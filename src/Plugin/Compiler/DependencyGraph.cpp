@@ -0,0 +1,359 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// For the time being, as there is no good alternative way in C++17 to get stream working than using codecvt
+#define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+
+#include "DependencyGraph.hpp"
+
+#include "..\Common\FileSystemUtil.hpp"
+#include "..\Common\StringUtil.hpp"
+#include "..\Lexer\Tokenizer.hpp"
+
+#include "..\..\external\gsl\include\gsl\util"
+
+#include <codecvt>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace papyrus {
+
+  namespace {
+    // Keywords that start a declaration visible to other scripts
+    const std::set<std::string> declarationKeywords {
+      "scriptname",
+      "property",
+      "function",
+      "event",
+      "customevent",
+      "struct"
+    };
+
+    inline std::wstring toWide(const std::string& str) { return std::wstring(str.begin(), str.end()); } // Script names only consist of ASCII chars
+    inline std::string toNarrow(const std::wstring& str) {
+      std::string narrow;
+      std::transform(str.begin(), str.end(), std::back_inserter(narrow), [](wchar_t ch) { return static_cast<char>(ch); });
+      return narrow;
+    }
+  }
+
+  std::vector<DependencyGraph::ScriptInfo> DependencyGraph::plan(const std::wstring& sourceDirectory, const std::vector<std::wstring>& importDirectories, bool supportNamespace, const std::wstring& outputDirectory, utility::hash_t flagsHash, bool ignoreTrivialChanges) {
+    if (!loaded) {
+      load();
+    }
+
+    std::map<std::string, std::wstring> buildScripts = discoverScripts(sourceDirectory, importDirectories, supportNamespace);
+
+    // Find out which scripts are out of date, in name order.
+    std::vector<ScriptInfo> result;
+    for (const auto& [scriptName, filePath] : buildScripts) {
+      const ScriptInfo* info = getScriptInfo(scriptName);
+      if (info != nullptr && !isUpToDate(*info, flagsHash, outputDirectory, ignoreTrivialChanges)) {
+        result.push_back(*info);
+      }
+    }
+    return result;
+  }
+
+  void DependencyGraph::scan(const std::wstring& sourceDirectory, const std::vector<std::wstring>& importDirectories, bool supportNamespace, std::vector<ScriptInfo>& scripts) {
+    discoverScripts(sourceDirectory, importDirectories, supportNamespace);
+    for (auto& script : scripts) {
+      script.scriptName = utility::toLower(script.scriptName);
+      knownScripts[script.scriptName] = script.filePath;
+      const ScriptInfo* info = getScriptInfo(script.scriptName);
+      if (info != nullptr) {
+        script = *info;
+      } else {
+        script.sourceHash = 0;
+      }
+    }
+  }
+
+  utility::hash_t DependencyGraph::getContentHash(const ScriptInfo& script) {
+    utility::hash_t contentHash = utility::hash(script.scriptName);
+    contentHash = utility::hashCombine(contentHash, script.sourceHash);
+    for (const auto& dependency : script.dependencies) {
+      contentHash = utility::hash(dependency, contentHash);
+      contentHash = utility::hashCombine(contentHash, getEffectiveInterfaceHash(dependency));
+    }
+    return contentHash;
+  }
+
+  bool DependencyGraph::isUpToDate(const ScriptInfo& script, utility::hash_t flagsHash, const std::wstring& outputDirectory, bool ignoreTrivialChanges) {
+    if (!loaded) {
+      load();
+    }
+
+    auto record = records.find(utility::toUpper(script.filePath));
+    if (record == records.end()
+      || (record->second.sourceHash != script.sourceHash && (!ignoreTrivialChanges || record->second.fingerprint != script.fingerprint))
+      || record->second.flagsHash != flagsHash
+      || !utility::fileExists(std::filesystem::path(outputDirectory) / getRelativePath(script.scriptName, L".pex"))) {
+      return false;
+    }
+
+    for (const auto& dependency : script.dependencies) {
+      auto importedInterface = record->second.importedInterfaces.find(dependency);
+      if (importedInterface == record->second.importedInterfaces.end() || importedInterface->second != getEffectiveInterfaceHash(dependency)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void DependencyGraph::markCompiled(const ScriptInfo& script, utility::hash_t flagsHash) {
+    BuildRecord record {
+      .sourceHash = script.sourceHash,
+      .fingerprint = script.fingerprint,
+      .flagsHash = flagsHash
+    };
+    for (const auto& dependency : script.dependencies) {
+      record.importedInterfaces[dependency] = getEffectiveInterfaceHash(dependency);
+    }
+    records[utility::toUpper(script.filePath)] = record;
+  }
+
+  void DependencyGraph::markFailed(const ScriptInfo& script) {
+    records.erase(utility::toUpper(script.filePath));
+  }
+
+  void DependencyGraph::save() const {
+    if (!graphPath.empty()) {
+      std::wofstream graphFile(graphPath, std::wofstream::trunc);
+      auto autoCleanup = gsl::finally([&] { graphFile.close(); });
+      graphFile.imbue(std::locale(graphFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+
+      // Each line has the format of: file path|source hash|fingerprint|flags hash|dependency=interface hash,...
+      for (const auto& [filePath, record] : records) {
+        graphFile << filePath << L'|' << utility::hashToStr(record.sourceHash) << L'|' << utility::hashToStr(record.fingerprint) << L'|' << utility::hashToStr(record.flagsHash) << L'|';
+        bool first = true;
+        for (const auto& [dependency, interfaceHash] : record.importedInterfaces) {
+          if (!first) {
+            graphFile << L',';
+          }
+          graphFile << toWide(dependency) << L'=' << utility::hashToStr(interfaceHash);
+          first = false;
+        }
+        graphFile << std::endl;
+      }
+    }
+  }
+
+  std::wstring DependencyGraph::getRelativePath(const std::string& scriptName, const std::wstring& extension) {
+    std::filesystem::path relativePath;
+    for (const auto& component : utility::split(scriptName, ":")) {
+      relativePath /= toWide(component);
+    }
+    relativePath += extension;
+    return relativePath;
+  }
+
+  // Private methods
+  //
+
+  void DependencyGraph::load() {
+    loaded = true;
+    records.clear();
+    if (!graphPath.empty()) {
+      std::wifstream graphFile(graphPath);
+      graphFile.imbue(std::locale(graphFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+      std::wstring line;
+      while (std::getline(graphFile, line)) {
+        auto fields = utility::split(line, L"|");
+        if (fields.size() == 5 && !fields[0].empty()) {
+          BuildRecord record {
+            .sourceHash = utility::strToHash(fields[1]),
+            .fingerprint = utility::strToHash(fields[2]),
+            .flagsHash = utility::strToHash(fields[3])
+          };
+          if (!fields[4].empty()) {
+            for (const auto& importedInterface : utility::split(fields[4], L",")) {
+              size_t equalsIndex = importedInterface.find_first_of(L'=');
+              if (equalsIndex != std::wstring::npos) {
+                record.importedInterfaces[toNarrow(importedInterface.substr(0, equalsIndex))] = utility::strToHash(importedInterface.substr(equalsIndex + 1));
+              }
+            }
+          }
+          records[fields[0]] = record;
+        }
+      }
+    }
+  }
+
+  std::map<std::string, std::wstring> DependencyGraph::discoverScripts(const std::wstring& sourceDirectory, const std::vector<std::wstring>& importDirectories, bool supportNamespace) {
+    // Scripts in source directory take precedence over those in import directories, same as PapyrusCompiler.
+    std::map<std::string, std::wstring> sourceScripts;
+    findScripts(sourceDirectory, "", supportNamespace, sourceScripts);
+    knownScripts = sourceScripts;
+    for (const auto& importDirectory : importDirectories) {
+      findScripts(importDirectory, "", supportNamespace, knownScripts);
+    }
+    scannedScripts.clear();
+    unreadableScripts.clear();
+    return sourceScripts;
+  }
+
+  void DependencyGraph::findScripts(const std::filesystem::path& directory, const std::string& namespacePrefix, bool supportNamespace, std::map<std::string, std::wstring>& scripts) {
+    const DirectoryListing& listing = listDirectory(directory);
+    for (const auto& [scriptName, filePath] : listing.scripts) {
+      scripts.emplace(namespacePrefix + scriptName, filePath);
+    }
+
+    if (supportNamespace) {
+      // Each subdirectory is a namespace component.
+      for (const auto& subdirectory : listing.subdirectories) {
+        findScripts(directory / subdirectory, namespacePrefix + utility::toLower(toNarrow(subdirectory)) + ":", true, scripts);
+      }
+    }
+  }
+
+  const DependencyGraph::DirectoryListing& DependencyGraph::listDirectory(const std::filesystem::path& directory) {
+    std::error_code errorCode;
+    auto modificationTime = std::filesystem::last_write_time(directory, errorCode);
+    DirectoryListing& listing = directoryListings[utility::toUpper(directory.wstring())];
+    if (errorCode) {
+      listing = DirectoryListing();
+      return listing;
+    }
+    if (listing.listed && listing.modificationTime == modificationTime) {
+      return listing;
+    }
+
+    listing = DirectoryListing {
+      .listed = true,
+      .modificationTime = modificationTime
+    };
+    for (const auto& entry : std::filesystem::directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, errorCode)) {
+      if (entry.is_symlink(errorCode)) {
+        continue; // Same as a recursive walk, which doesn't follow directory links
+      }
+      if (entry.is_directory(errorCode)) {
+        listing.subdirectories.push_back(entry.path().filename().wstring());
+      } else if (entry.is_regular_file(errorCode) && utility::compare(entry.path().extension().wstring(), L".psc")) {
+        listing.scripts.emplace_back(utility::toLower(toNarrow(entry.path().stem().wstring())), entry.path().wstring());
+      }
+    }
+    return listing;
+  }
+
+  bool DependencyGraph::scanScript(const std::wstring& filePath, const std::string& scriptName, ScriptInfo& info) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (file.fail()) {
+      return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    info = ScriptInfo {
+      .filePath = filePath,
+      .scriptName = scriptName,
+      .sourceHash = utility::hash(content)
+    };
+
+    // Go through each logical line. Every identifier is a dependency candidate, which will be checked against known scripts later.
+    Tokenizer tokenizer(content);
+    Tokenizer::Token token;
+    std::vector<std::string> lineTokens;
+    bool inStruct = false;
+    utility::hash_t fingerprint = utility::HASH_OFFSET_BASIS;
+    utility::hash_t interfaceHash = utility::HASH_OFFSET_BASIS;
+    while (tokenizer.next(token)) {
+      // Tokenizer skips comments and whitespace, so only tokens and logical line ends are left to determine compiled code.
+      // Line of each token is included too, as compiled script's debug info maps code to source lines.
+      fingerprint = utility::hash(token.content, fingerprint);
+      fingerprint = utility::hash(&token.line, sizeof(token.line), fingerprint);
+      fingerprint = utility::hash(token.tokenType == Tokenizer::TokenType::LineEnd ? "\n" : " ", fingerprint);
+      if (token.tokenType != Tokenizer::TokenType::LineEnd) {
+        std::string word = utility::toLower(std::string(token.content)); // Papyrus script is case insensitive
+        if (token.tokenType == Tokenizer::TokenType::Identifier) {
+          info.dependencies.insert(word);
+        }
+        lineTokens.push_back(word);
+        continue;
+      }
+
+      const std::string& firstToken = lineTokens.front();
+      if (firstToken == "scriptname") {
+        auto extends = std::find(lineTokens.begin(), lineTokens.end(), "extends");
+        if (extends != lineTokens.end() && std::next(extends) != lineTokens.end()) {
+          info.parent = *std::next(extends);
+        }
+      }
+
+      // Struct members are part of the interface as well.
+      bool isDeclaration = inStruct || std::any_of(lineTokens.begin(), lineTokens.end(), [](const auto& word) { return declarationKeywords.contains(word); });
+      if (firstToken == "struct") {
+        inStruct = true;
+      } else if (firstToken == "endstruct") {
+        inStruct = false;
+      }
+
+      if (isDeclaration) {
+        for (const auto& word : lineTokens) {
+          interfaceHash = utility::hash(word, interfaceHash);
+          interfaceHash = utility::hash(" ", interfaceHash);
+        }
+        interfaceHash = utility::hash("\n", interfaceHash);
+      }
+      lineTokens.clear();
+    }
+    info.fingerprint = fingerprint;
+    info.interfaceHash = interfaceHash;
+    info.dependencies.erase(scriptName);
+    return true;
+  }
+
+  const DependencyGraph::ScriptInfo* DependencyGraph::getScriptInfo(const std::string& scriptName) {
+    auto scanned = scannedScripts.find(scriptName);
+    if (scanned != scannedScripts.end()) {
+      return &scanned->second;
+    }
+
+    auto known = knownScripts.find(scriptName);
+    if (known == knownScripts.end() || unreadableScripts.contains(scriptName)) {
+      return nullptr;
+    }
+
+    ScriptInfo info;
+    if (!scanScript(known->second, scriptName, info)) {
+      unreadableScripts.insert(scriptName);
+      return nullptr;
+    }
+
+    // Only keep candidates that are known scripts.
+    std::erase_if(info.dependencies, [&](const auto& dependency) { return !knownScripts.contains(dependency); });
+    return &(scannedScripts[scriptName] = std::move(info));
+  }
+
+  utility::hash_t DependencyGraph::getEffectiveInterfaceHash(const std::string& scriptName) {
+    utility::hash_t interfaceHash = utility::HASH_OFFSET_BASIS;
+    std::set<std::string> visited;
+    std::string current = scriptName;
+    while (!current.empty() && visited.insert(current).second) {
+      const ScriptInfo* info = getScriptInfo(current);
+      if (info == nullptr) {
+        break;
+      }
+      interfaceHash = utility::hashCombine(interfaceHash, info->interfaceHash);
+      current = info->parent;
+    }
+    return interfaceHash;
+  }
+
+} // namespace
@@ -0,0 +1,130 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "..\Common\HashUtil.hpp"
+
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace papyrus {
+
+  // Keeps track of dependencies between scripts, established through "Extends", "Import" and type references, along with hashes
+  // of their sources, interfaces and compiler flags used in the last successful compilation, so an incremental build can find out
+  // which scripts need to be recompiled. The graph is persisted in a file so it survives Notepad++ restarts.
+  class DependencyGraph {
+    public:
+      // Information scanned from a script's current source
+      struct ScriptInfo {
+        std::wstring filePath;
+        std::string scriptName; // Lower case, with FO4's namespace components separated by ':'
+        utility::hash_t sourceHash {0};
+        utility::hash_t fingerprint {0};   // Covers tokens of source and their lines only, so it doesn't change when only comments or whitespace within lines are changed
+        utility::hash_t interfaceHash {0}; // Covers declarations visible to other scripts, i.e. script name, properties, functions, events and structs
+        std::string parent;
+        std::set<std::string> dependencies;
+      };
+
+      inline void init(const std::wstring& path) { graphPath = path; }
+
+      // Find out scripts under source directory that need to be recompiled, i.e. scripts that are changed, compiled with different
+      // flags, missing output, or depending on scripts whose interfaces are changed. The result is in script name order, as they are
+      // compiled together and compiler resolves imported scripts from their sources. If "ignoreTrivialChanges" is true, scripts with
+      // only comments or whitespace changed are not recompiled.
+      std::vector<ScriptInfo> plan(const std::wstring& sourceDirectory, const std::vector<std::wstring>& importDirectories, bool supportNamespace, const std::wstring& outputDirectory, utility::hash_t flagsHash, bool ignoreTrivialChanges);
+
+      // Scan scripts that are compiled outside of an incremental build. File path and script name of each script need to be set,
+      // and the rest of information is filled in. Scripts that cannot be read are left with zero source hash
+      void scan(const std::wstring& sourceDirectory, const std::vector<std::wstring>& importDirectories, bool supportNamespace, std::vector<ScriptInfo>& scripts);
+
+      // Hash of everything in scripts that determines compiled output of a script returned by plan() or scan(), i.e. its source and
+      // effective interfaces of its dependencies
+      utility::hash_t getContentHash(const ScriptInfo& script);
+
+      // Check if a script returned by plan() or scan() has the same content as its last successful compilation with the same flags,
+      // and its output still exists
+      bool isUpToDate(const ScriptInfo& script, utility::hash_t flagsHash, const std::wstring& outputDirectory, bool ignoreTrivialChanges);
+
+      // Record a successful compilation of a script returned by plan() or scan()
+      void markCompiled(const ScriptInfo& script, utility::hash_t flagsHash);
+
+      // Forget a script's build record so it will be recompiled by next build
+      void markFailed(const ScriptInfo& script);
+
+      void save() const;
+
+      // Get the relative path of a script's source or output file, e.g. "ns:script" -> "ns\script.psc"
+      static std::wstring getRelativePath(const std::string& scriptName, const std::wstring& extension);
+
+    private:
+      struct BuildRecord {
+        utility::hash_t sourceHash {0};
+        utility::hash_t fingerprint {0};
+        utility::hash_t flagsHash {0};
+        std::map<std::string, utility::hash_t> importedInterfaces; // Effective interface hash of each dependency at the time of compilation
+      };
+
+      void load();
+
+      // Find scripts in source and import directories, and reset data of current plan. Returns scripts in source directory
+      std::map<std::string, std::wstring> discoverScripts(const std::wstring& sourceDirectory, const std::vector<std::wstring>& importDirectories, bool supportNamespace);
+
+      // Scripts and subdirectories directly under a directory, as of its last modification time
+      struct DirectoryListing {
+        bool listed {false};
+        std::filesystem::file_time_type modificationTime {};
+        std::vector<std::pair<std::string, std::wstring>> scripts; // Lower case script name without namespace, and file path
+        std::vector<std::wstring> subdirectories;
+      };
+
+      // Find all script files under a directory. Subdirectories are only searched if namespace is supported (FO4).
+      // Scripts that are already found will not be overwritten, so directories should be searched in the order of precedence.
+      void findScripts(const std::filesystem::path& directory, const std::string& namespacePrefix, bool supportNamespace, std::map<std::string, std::wstring>& scripts);
+
+      // Get cached listing of a directory. A directory's modification time changes when entries are added, removed or renamed
+      // in it, so it is only listed again when that happens, sparing a full walk of import directories on every compilation
+      const DirectoryListing& listDirectory(const std::filesystem::path& directory);
+
+      // Scan a script file for its dependency candidates, interface declarations, and hashes
+      static bool scanScript(const std::wstring& filePath, const std::string& scriptName, ScriptInfo& info);
+
+      // Get scanned information of a known script, scanning it if not done yet in current plan
+      const ScriptInfo* getScriptInfo(const std::string& scriptName);
+
+      // Interface hash of a script combined with those of the scripts it extends, since inherited members are visible to dependents
+      utility::hash_t getEffectiveInterfaceHash(const std::string& scriptName);
+
+      // Private members
+      //
+      std::wstring graphPath;
+      bool loaded {false};
+      std::map<std::wstring, BuildRecord> records; // Keyed by upper case file path
+      std::map<std::wstring, DirectoryListing> directoryListings; // Keyed by upper case directory path
+
+      // Data only valid during current plan or scan
+      std::map<std::string, std::wstring> knownScripts;
+      std::map<std::string, ScriptInfo> scannedScripts;
+      std::set<std::string> unreadableScripts;
+  };
+
+} // namespace
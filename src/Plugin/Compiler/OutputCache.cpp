@@ -0,0 +1,223 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OutputCache.hpp"
+
+#include "..\Common\StringUtil.hpp"
+
+#include "..\..\external\gsl\include\gsl\util"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include <windows.h>
+
+namespace papyrus {
+
+  namespace {
+    constexpr wchar_t INDEX_FILE_NAME[] = L"index";
+    constexpr wchar_t STATISTICS_RECORD_NAME[] = L"stats";
+
+    std::uint64_t strToUInt64(const std::wstring& str) noexcept {
+      try {
+        return std::stoull(str);
+      } catch (...) {
+        return 0;
+      }
+    }
+  }
+
+  void OutputCache::setMaxSize(std::uint64_t size) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    maxSize = size;
+    if (maxSize > 0) {
+      if (!loaded) {
+        load();
+      }
+      evict();
+    }
+  }
+
+  bool OutputCache::isEnabled() const {
+    return maxSize > 0 && !cacheDirectory.empty();
+  }
+
+  bool OutputCache::restore(utility::hash_t key, const std::wstring& outputFile) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded) {
+      load();
+    }
+
+    modified = true;
+    auto iter = entries.find(key);
+    if (iter != entries.end()) {
+      std::wstring cachedFile = getCachedFilePath(key);
+      std::error_code errorCode;
+      std::filesystem::create_directories(std::filesystem::path(outputFile).parent_path(), errorCode);
+      if (::CopyFile(cachedFile.c_str(), outputFile.c_str(), FALSE)) {
+        iter->second.lastUsed = ++sequence;
+        hits++;
+        return true;
+      }
+
+      if (!std::filesystem::exists(cachedFile, errorCode)) {
+        // Cached file was removed externally.
+        totalSize -= iter->second.size;
+        entries.erase(iter);
+      }
+    }
+    misses++;
+    return false;
+  }
+
+  void OutputCache::store(utility::hash_t key, const std::wstring& outputFile) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (maxSize == 0 || cacheDirectory.empty()) {
+      return;
+    }
+    if (!loaded) {
+      load();
+    }
+
+    std::error_code errorCode;
+    std::uint64_t size = std::filesystem::file_size(outputFile, errorCode);
+    if (errorCode || size > maxSize) {
+      return;
+    }
+
+    modified = true;
+    auto iter = entries.find(key);
+    if (iter != entries.end()) {
+      // Same key always produces the same output, so only its access order needs to be updated.
+      iter->second.lastUsed = ++sequence;
+      return;
+    }
+
+    std::filesystem::create_directories(cacheDirectory, errorCode);
+    if (::CopyFile(outputFile.c_str(), getCachedFilePath(key).c_str(), FALSE)) {
+      entries[key] = Entry {
+        .size = size,
+        .lastUsed = ++sequence
+      };
+      totalSize += size;
+      evict();
+    }
+  }
+
+  void OutputCache::clear() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded) {
+      load();
+    }
+
+    for (const auto& [key, entry] : entries) {
+      ::DeleteFile(getCachedFilePath(key).c_str());
+    }
+    entries.clear();
+    totalSize = 0;
+    sequence = 0;
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+    modified = true;
+  }
+
+  OutputCache::Statistics OutputCache::getStatistics() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded) {
+      load();
+    }
+
+    return Statistics {
+      .hits = hits,
+      .misses = misses,
+      .evictions = evictions,
+      .entryCount = entries.size(),
+      .totalSize = totalSize,
+      .maxSize = maxSize
+    };
+  }
+
+  void OutputCache::save() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!modified || cacheDirectory.empty()) {
+      return;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(cacheDirectory, errorCode);
+    std::wofstream indexFile(std::filesystem::path(cacheDirectory) / INDEX_FILE_NAME, std::wofstream::trunc);
+    auto autoCleanup = gsl::finally([&] { indexFile.close(); });
+
+    // First line has the format of: stats|hits|misses|evictions. Each of the other lines has the format of: key|size|last used
+    indexFile << STATISTICS_RECORD_NAME << L'|' << hits << L'|' << misses << L'|' << evictions << std::endl;
+    for (const auto& [key, entry] : entries) {
+      indexFile << utility::hashToStr(key) << L'|' << entry.size << L'|' << entry.lastUsed << std::endl;
+    }
+    modified = false;
+  }
+
+  // Private methods
+  //
+
+  void OutputCache::load() {
+    loaded = true;
+    entries.clear();
+    totalSize = 0;
+    if (cacheDirectory.empty()) {
+      return;
+    }
+
+    std::wifstream indexFile(std::filesystem::path(cacheDirectory) / INDEX_FILE_NAME);
+    std::wstring line;
+    while (std::getline(indexFile, line)) {
+      auto fields = utility::split(line, L"|");
+      if (fields.size() == 4 && fields[0] == STATISTICS_RECORD_NAME) {
+        hits = strToUInt64(fields[1]);
+        misses = strToUInt64(fields[2]);
+        evictions = strToUInt64(fields[3]);
+      } else if (fields.size() == 3) {
+        Entry entry {
+          .size = strToUInt64(fields[1]),
+          .lastUsed = strToUInt64(fields[2])
+        };
+        entries[utility::strToHash(fields[0])] = entry;
+        totalSize += entry.size;
+        sequence = std::max(sequence, entry.lastUsed);
+      }
+    }
+  }
+
+  void OutputCache::evict() {
+    while (totalSize > maxSize && !entries.empty()) {
+      auto leastRecentlyUsed = std::min_element(entries.begin(), entries.end(), [](const auto& entry1, const auto& entry2) { return entry1.second.lastUsed < entry2.second.lastUsed; });
+      ::DeleteFile(getCachedFilePath(leastRecentlyUsed->first).c_str());
+      totalSize -= leastRecentlyUsed->second.size;
+      entries.erase(leastRecentlyUsed);
+      evictions++;
+      modified = true;
+    }
+  }
+
+  std::wstring OutputCache::getCachedFilePath(utility::hash_t key) const {
+    return (std::filesystem::path(cacheDirectory) / (utility::hashToStr(key) + L".pex")).wstring();
+  }
+
+} // namespace
@@ -0,0 +1,88 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "..\Common\HashUtil.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace papyrus {
+
+  // Content-addressed cache of compiled PEX files. Each entry is keyed by a hash of everything that determines compiler output, so
+  // switching back to previously compiled sources can restore their outputs without running the compiler. Least recently used
+  // entries are evicted when the cache grows beyond its size limit. Entries and statistics are persisted in the cache directory.
+  class OutputCache {
+    public:
+      struct Statistics {
+        std::uint64_t hits {0};
+        std::uint64_t misses {0};
+        std::uint64_t evictions {0};
+        size_t entryCount {0};
+        std::uint64_t totalSize {0};
+        std::uint64_t maxSize {0};
+      };
+
+      inline void init(const std::wstring& directory) { cacheDirectory = directory; }
+
+      // Limit of total size of cached files. 0 disables the cache
+      void setMaxSize(std::uint64_t size);
+      bool isEnabled() const;
+
+      // Copy cached output of the given key to output file. Returns false on cache miss
+      bool restore(utility::hash_t key, const std::wstring& outputFile);
+
+      // Add a newly compiled output file to cache, evicting least recently used entries if needed
+      void store(utility::hash_t key, const std::wstring& outputFile);
+
+      // Remove all cached files and reset statistics
+      void clear();
+
+      Statistics getStatistics();
+      void save();
+
+    private:
+      struct Entry {
+        std::uint64_t size {0};
+        std::uint64_t lastUsed {0}; // Sequence number of last access
+      };
+
+      void load();
+      void evict();
+      std::wstring getCachedFilePath(utility::hash_t key) const;
+
+      // Private members
+      //
+      std::mutex cacheMutex;
+      std::wstring cacheDirectory;
+      bool loaded {false};
+      bool modified {false};
+      std::map<utility::hash_t, Entry> entries;
+      std::uint64_t totalSize {0};
+      std::uint64_t maxSize {0};
+      std::uint64_t sequence {0};
+      std::uint64_t hits {0};
+      std::uint64_t misses {0};
+      std::uint64_t evictions {0};
+  };
+
+} // namespace
@@ -0,0 +1,163 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// For the time being, as there is no good alternative way in C++17 to get stream working than using codecvt
+#define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+
+#include "OutputDeployer.hpp"
+
+#include "..\Common\FileSystemUtil.hpp"
+#include "..\Common\StringUtil.hpp"
+
+#include "..\..\external\gsl\include\gsl\util"
+
+#include <algorithm>
+#include <codecvt>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#include <windows.h>
+
+namespace papyrus {
+
+  namespace {
+    constexpr wchar_t TEMPORARY_FILE_SUFFIX[] = L".deploying";
+
+    struct CopyTask {
+      size_t deployDirectoryIndex {0};
+      size_t fileIndex {0};
+      bool succeeded {false};
+    };
+  }
+
+  bool OutputDeployer::deploy(const std::wstring& outputDirectory, const std::vector<std::wstring>& relativePaths, const std::vector<std::wstring>& deployDirectories, size_t& copiedCount, std::wstring& errorMsg) {
+    copiedCount = 0;
+    if (deployDirectories.empty() || relativePaths.empty()) {
+      return true;
+    }
+
+    // Each output is hashed once, no matter how many directories it is deployed to. Outputs that cannot be read are left with zero hash.
+    std::vector<utility::hash_t> hashes(relativePaths.size());
+    std::for_each(std::execution::par, relativePaths.begin(), relativePaths.end(),
+      [&](const auto& relativePath) {
+        utility::hash_t& hash = hashes[&relativePath - relativePaths.data()];
+        if (!utility::hashFile((std::filesystem::path(outputDirectory) / relativePath).wstring(), hash)) {
+          hash = 0;
+        }
+      }
+    );
+
+    std::vector<manifest_t> manifests;
+    std::vector<CopyTask> tasks;
+    for (size_t i = 0; i < deployDirectories.size(); ++i) {
+      manifest_t& manifest = manifests.emplace_back(loadManifest(deployDirectories[i]));
+      for (size_t j = 0; j < relativePaths.size(); ++j) {
+        if (hashes[j] != 0) {
+          auto deployed = manifest.find(utility::toUpper(relativePaths[j]));
+          if (deployed == manifest.end() || deployed->second != hashes[j] || !utility::fileExists((std::filesystem::path(deployDirectories[i]) / relativePaths[j]).wstring())) {
+            tasks.push_back(CopyTask {
+              .deployDirectoryIndex = i,
+              .fileIndex = j
+            });
+          }
+        }
+      }
+    }
+
+    std::mutex errorMutex;
+    std::for_each(std::execution::par, tasks.begin(), tasks.end(),
+      [&](CopyTask& task) {
+        std::filesystem::path sourceFile = std::filesystem::path(outputDirectory) / relativePaths[task.fileIndex];
+        std::filesystem::path targetFile = std::filesystem::path(deployDirectories[task.deployDirectoryIndex]) / relativePaths[task.fileIndex];
+        std::wstring temporaryFile = targetFile.wstring() + TEMPORARY_FILE_SUFFIX;
+        std::error_code errorCode;
+        std::filesystem::create_directories(targetFile.parent_path(), errorCode);
+        task.succeeded = ::CopyFile(sourceFile.c_str(), temporaryFile.c_str(), FALSE) && ::MoveFileEx(temporaryFile.c_str(), targetFile.c_str(), MOVEFILE_REPLACE_EXISTING);
+        if (!task.succeeded) {
+          DWORD lastError = ::GetLastError();
+          ::DeleteFile(temporaryFile.c_str());
+          std::lock_guard<std::mutex> lock(errorMutex);
+          if (errorMsg.empty()) {
+            errorMsg = L"Deploying " + sourceFile.wstring() + L" to " + targetFile.wstring() + L" failed. Error code: " + std::to_wstring(lastError);
+          }
+        }
+      }
+    );
+
+    for (const auto& task : tasks) {
+      if (task.succeeded) {
+        manifests[task.deployDirectoryIndex][utility::toUpper(relativePaths[task.fileIndex])] = hashes[task.fileIndex];
+        copiedCount++;
+      }
+    }
+    for (size_t i = 0; i < deployDirectories.size(); ++i) {
+      saveManifest(deployDirectories[i], manifests[i]);
+    }
+    return errorMsg.empty();
+  }
+
+  // Private methods
+  //
+
+  std::wstring OutputDeployer::getManifestFilePath(const std::wstring& deployDirectory) const {
+    return (std::filesystem::path(manifestDirectory) / (utility::hashToStr(utility::hash(utility::toUpper(deployDirectory))) + L".manifest")).wstring();
+  }
+
+  OutputDeployer::manifest_t OutputDeployer::loadManifest(const std::wstring& deployDirectory) const {
+    manifest_t manifest;
+    if (manifestDirectory.empty()) {
+      return manifest;
+    }
+
+    std::wifstream manifestFile(getManifestFilePath(deployDirectory));
+    manifestFile.imbue(std::locale(manifestFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+
+    // First line is the deploy directory. Each of the other lines has the format of: relative path|content hash
+    std::wstring line;
+    if (std::getline(manifestFile, line) && utility::compare(line, deployDirectory)) {
+      while (std::getline(manifestFile, line)) {
+        auto fields = utility::split(line, L"|");
+        if (fields.size() == 2 && !fields[0].empty()) {
+          manifest[fields[0]] = utility::strToHash(fields[1]);
+        }
+      }
+    }
+    return manifest;
+  }
+
+  void OutputDeployer::saveManifest(const std::wstring& deployDirectory, const manifest_t& manifest) const {
+    if (manifestDirectory.empty()) {
+      return;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(manifestDirectory, errorCode);
+    std::wofstream manifestFile(getManifestFilePath(deployDirectory), std::wofstream::trunc);
+    auto autoCleanup = gsl::finally([&] { manifestFile.close(); });
+    manifestFile.imbue(std::locale(manifestFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+
+    manifestFile << deployDirectory << std::endl;
+    for (const auto& [relativePath, hash] : manifest) {
+      manifestFile << relativePath << L'|' << utility::hashToStr(hash) << std::endl;
+    }
+  }
+
+} // namespace
@@ -0,0 +1,54 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "..\Common\HashUtil.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace papyrus {
+
+  // Copies compiled outputs to deploy directories, e.g. a mod manager's mod folder or a test profile. Content hash of each deployed
+  // file is recorded in a manifest per deploy directory, kept in manifest directory so deploy directories only contain deployed
+  // files, and only outputs whose content has changed since last deployment are copied.
+  class OutputDeployer {
+    public:
+      inline void init(const std::wstring& directory) { manifestDirectory = directory; }
+
+      // Copy output files, given as paths relative to output directory, to the same relative paths in each deploy directory.
+      // Files are copied in parallel, each to a temporary file that is then renamed, so a deployed file is never partially
+      // written. If any copy fails, the first error message is returned
+      bool deploy(const std::wstring& outputDirectory, const std::vector<std::wstring>& relativePaths, const std::vector<std::wstring>& deployDirectories, size_t& copiedCount, std::wstring& errorMsg);
+
+    private:
+      using manifest_t = std::map<std::wstring, utility::hash_t>; // Content hash of deployed files, keyed by upper case relative path
+
+      std::wstring getManifestFilePath(const std::wstring& deployDirectory) const;
+      manifest_t loadManifest(const std::wstring& deployDirectory) const;
+      void saveManifest(const std::wstring& deployDirectory, const manifest_t& manifest) const;
+
+      // Private members
+      //
+      std::wstring manifestDirectory;
+  };
+
+} // namespace
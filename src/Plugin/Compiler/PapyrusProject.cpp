@@ -0,0 +1,225 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PapyrusProject.hpp"
+
+#include "..\Common\StringUtil.hpp"
+
+#include "..\..\external\gsl\include\gsl\util"
+#include "..\..\external\tinyxml2\tinyxml2.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <set>
+#include <utility>
+
+#include <windows.h>
+
+namespace papyrus {
+
+  namespace {
+    // Project file format:
+    //   <PapyrusProject Output="..." Flags="..." Optimize="true" Release="true" Final="true">
+    //     <Variables><Variable Name="..." Value="..."/></Variables>
+    //     <Imports><Import>...</Import></Imports>
+    //     <Folders><Folder NoRecurse="true">...</Folder></Folders>
+    //     <Scripts><Script>...</Script></Scripts>
+    //   </PapyrusProject>
+    using variables_t = std::vector<std::pair<std::wstring, std::wstring>>;
+
+    std::wstring fromUtf8(const char* text) {
+      if (text == nullptr || *text == '\0') {
+        return std::wstring();
+      }
+      int length = ::MultiByteToWideChar(CP_UTF8, 0, text, -1, nullptr, 0);
+      std::wstring wideText(length, L'\0');
+      ::MultiByteToWideChar(CP_UTF8, 0, text, -1, wideText.data(), length);
+      wideText.pop_back(); // Remove the terminating null char
+      return wideText;
+    }
+
+    inline std::string toNarrow(const std::wstring& str) {
+      std::string narrow;
+      std::transform(str.begin(), str.end(), std::back_inserter(narrow), [](wchar_t ch) { return static_cast<char>(ch); });
+      return narrow;
+    }
+
+    // Text of an element or attribute with variables expanded, and surrounding spaces removed
+    std::wstring expand(const char* text, const variables_t& variables) {
+      std::wstring result = fromUtf8(text);
+      for (const auto& [name, value] : variables) {
+        for (size_t index = 0; (index = result.find(name, index)) != std::wstring::npos; index += value.size()) {
+          result.replace(index, name.size(), value);
+        }
+      }
+      size_t start = result.find_first_not_of(L" \t\r\n");
+      return start == std::wstring::npos ? std::wstring() : result.substr(start, result.find_last_not_of(L" \t\r\n") - start + 1);
+    }
+
+    std::wstring resolvePath(const std::wstring& path, const std::filesystem::path& projectDirectory) {
+      std::filesystem::path resolvedPath(path);
+      return resolvedPath.is_absolute() ? path : (projectDirectory / resolvedPath).lexically_normal().wstring();
+    }
+
+    std::optional<bool> getFlag(const tinyxml2::XMLElement* element, const char* name) {
+      bool value {};
+      if (element->QueryBoolAttribute(name, &value) == tinyxml2::XML_SUCCESS) {
+        return value;
+      }
+      return std::nullopt;
+    }
+
+    // Script name of a file under a folder, with relative directories as namespace
+    std::string getScriptName(const std::filesystem::path& relativePath) {
+      std::string scriptName;
+      for (const auto& component : relativePath.parent_path()) {
+        scriptName += toNarrow(component.wstring()) + ":";
+      }
+      return scriptName + toNarrow(relativePath.stem().wstring());
+    }
+  }
+
+  bool PapyrusProject::load(const std::wstring& filePath, PapyrusProject& project, std::wstring& errorMsg) {
+    FILE* file {};
+    if (::_wfopen_s(&file, filePath.c_str(), L"rb") != 0 || file == nullptr) {
+      errorMsg = L"Cannot open project file " + filePath;
+      return false;
+    }
+    auto autoCleanup = gsl::finally([&] { ::fclose(file); });
+
+    tinyxml2::XMLDocument xmlDoc;
+    if (xmlDoc.LoadFile(file) != tinyxml2::XML_SUCCESS) {
+      errorMsg = L"Cannot parse project file " + filePath + L": " + fromUtf8(xmlDoc.ErrorStr());
+      return false;
+    }
+    const tinyxml2::XMLElement* root = xmlDoc.FirstChildElement("PapyrusProject");
+    if (root == nullptr) {
+      errorMsg = L"Not a Papyrus project file: " + filePath;
+      return false;
+    }
+
+    // Expand longer variable names first, so a name that is a prefix of another one doesn't break it.
+    variables_t variables;
+    if (const auto* variablesElement = root->FirstChildElement("Variables")) {
+      for (const auto* element = variablesElement->FirstChildElement("Variable"); element != nullptr; element = element->NextSiblingElement("Variable")) {
+        std::wstring name = fromUtf8(element->Attribute("Name"));
+        if (!name.empty()) {
+          variables.push_back(std::make_pair(L"@" + name, expand(element->Attribute("Value"), variables)));
+        }
+      }
+    }
+    std::sort(variables.begin(), variables.end(), [](const auto& variable1, const auto& variable2) { return variable1.first.size() > variable2.first.size(); });
+
+    std::filesystem::path projectDirectory = std::filesystem::path(filePath).parent_path();
+    project = PapyrusProject {
+      .optimizeFlag = getFlag(root, "Optimize"),
+      .releaseFlag = getFlag(root, "Release"),
+      .finalFlag = getFlag(root, "Final")
+    };
+    if (std::wstring output = expand(root->Attribute("Output"), variables); !output.empty()) {
+      project.outputDirectory = resolvePath(output, projectDirectory);
+    }
+    project.flagFile = expand(root->Attribute("Flags"), variables); // Compiler searches flag file in import directories
+
+    if (const auto* importsElement = root->FirstChildElement("Imports")) {
+      for (const auto* element = importsElement->FirstChildElement("Import"); element != nullptr; element = element->NextSiblingElement("Import")) {
+        if (std::wstring importDirectory = expand(element->GetText(), variables); !importDirectory.empty()) {
+          project.importDirectories += (project.importDirectories.empty() ? L"" : L";") + resolvePath(importDirectory, projectDirectory);
+        }
+      }
+    }
+
+    std::set<std::string> scriptNames;
+    auto addScript = [&](Script&& script) {
+      if (scriptNames.insert(utility::toLower(script.scriptName)).second) {
+        project.scripts.push_back(std::move(script));
+      }
+    };
+
+    // Scripts are passed to compiler as written, which resolves them from working directory or import directories.
+    if (const auto* scriptsElement = root->FirstChildElement("Scripts")) {
+      for (const auto* element = scriptsElement->FirstChildElement("Script"); element != nullptr; element = element->NextSiblingElement("Script")) {
+        std::wstring target = expand(element->GetText(), variables);
+        if (target.empty()) {
+          continue;
+        }
+
+        // Relative path and script name are both accepted, e.g. "MyMod\MyScript.psc" and "MyMod:MyScript".
+        std::filesystem::path scriptPath(target);
+        std::string scriptName;
+        if (scriptPath.is_absolute()) {
+          scriptName = toNarrow(scriptPath.stem().wstring());
+        } else {
+          scriptName = toNarrow(utility::endsWith(target, L".psc") ? target.substr(0, target.size() - 4) : target);
+          std::replace_if(scriptName.begin(), scriptName.end(), [](char ch) { return ch == '\\' || ch == '/'; }, ':');
+        }
+        addScript(Script {
+          .target = target,
+          .workingDirectory = projectDirectory.wstring(),
+          .scriptName = scriptName
+        });
+      }
+    }
+
+    // Scripts in folders are compiled from folder root, with subdirectories as namespaces.
+    if (const auto* foldersElement = root->FirstChildElement("Folders")) {
+      for (const auto* element = foldersElement->FirstChildElement("Folder"); element != nullptr; element = element->NextSiblingElement("Folder")) {
+        std::wstring folder = expand(element->GetText(), variables);
+        if (folder.empty()) {
+          continue;
+        }
+
+        folder = resolvePath(folder, projectDirectory);
+        std::error_code errorCode;
+        if (!std::filesystem::is_directory(folder, errorCode)) {
+          errorMsg = L"Folder listed in project does not exist: " + folder;
+          return false;
+        }
+
+        auto addFile = [&](const std::filesystem::directory_entry& entry) {
+          if (entry.is_regular_file(errorCode) && utility::compare(entry.path().extension().wstring(), L".psc")) {
+            addScript(Script {
+              .target = entry.path().wstring(),
+              .workingDirectory = folder,
+              .scriptName = getScriptName(entry.path().lexically_relative(folder))
+            });
+          }
+        };
+        if (element->BoolAttribute("NoRecurse", false)) {
+          for (const auto& entry : std::filesystem::directory_iterator(folder, std::filesystem::directory_options::skip_permission_denied, errorCode)) {
+            addFile(entry);
+          }
+        } else {
+          for (const auto& entry : std::filesystem::recursive_directory_iterator(folder, std::filesystem::directory_options::skip_permission_denied, errorCode)) {
+            addFile(entry);
+          }
+        }
+      }
+    }
+
+    if (project.scripts.empty()) {
+      errorMsg = L"No script is listed in project file " + filePath;
+      return false;
+    }
+    return true;
+  }
+
+} // namespace
@@ -0,0 +1,51 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace papyrus {
+
+  // Papyrus project file (.ppj) used by Fallout 4's Creation Kit, which lists scripts and folders to compile along with
+  // import directories and compiler flags.
+  struct PapyrusProject {
+    struct Script {
+      std::wstring target;           // Passed to compiler as is, either a script name or a file path
+      std::wstring workingDirectory;
+      std::string scriptName;        // Determines output file path, namespace components are separated by ':'
+    };
+
+    // Settings that are not specified in project are left empty, so game settings are used instead
+    std::wstring outputDirectory;
+    std::wstring flagFile;
+    std::wstring importDirectories; // Semicolon delimited
+    std::optional<bool> optimizeFlag;
+    std::optional<bool> releaseFlag;
+    std::optional<bool> finalFlag;
+    std::vector<Script> scripts;
+
+    // Load a project file. Variables ("@Name") are expanded, and relative paths are resolved against project file's directory.
+    // Scripts listed in folders are discovered, and each script is only listed once
+    static bool load(const std::wstring& filePath, PapyrusProject& project, std::wstring& errorMsg);
+  };
+
+} // namespace
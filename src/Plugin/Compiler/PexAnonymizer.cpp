@@ -0,0 +1,129 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PexAnonymizer.hpp"
+
+#include "..\Common\MemoryMappedFile.hpp"
+#include "..\Common\StringUtil.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <execution>
+#include <filesystem>
+#include <mutex>
+
+namespace papyrus {
+
+  namespace {
+    // PEX file format (Skyrim & SSE in big endian, FO4 in little endian):
+    //   Signature:         4 bytes. Value: 0xFA57C0DE (stored as FA 57 C0 DE in Skyrim & Skyrim SE, DE C0 57 FA in Fallout 4)
+    //   Major version:     1 byte.
+    //   Minor version:     1 byte.
+    //   Game ID:           2 bytes.
+    //   Compilation time:  8 bytes.
+    //   Script path size:  2 bytes.
+    //   Script path:       n bytes.
+    //   User name size:    2 bytes.
+    //   User name:         n bytes.
+    //   Host name size:    2 bytes.
+    //   Host name:         n bytes.
+    constexpr size_t SCRIPT_PATH_OFFSET = 16;
+    constexpr int ANONYMIZED_FIELD_COUNT = 3;
+  }
+
+  bool PexAnonymizer::anonymize(const std::wstring& filePath, std::wstring& errorMsg) {
+    utility::MemoryMappedFile file;
+    if (!file.open(filePath, true, errorMsg)) {
+      return false;
+    }
+
+    if (!anonymizeContent(file.data(), file.size())) {
+      errorMsg = L"Unknown PEX file format: " + filePath;
+      return false;
+    }
+    return true;
+  }
+
+  bool PexAnonymizer::anonymize(const std::vector<std::wstring>& filePaths, std::wstring& errorMsg) {
+    std::mutex errorMutex;
+    bool noError = true;
+    std::for_each(std::execution::par, filePaths.begin(), filePaths.end(),
+      [&](const auto& filePath) {
+        std::wstring fileErrorMsg;
+        if (!anonymize(filePath, fileErrorMsg)) {
+          std::lock_guard<std::mutex> lock(errorMutex);
+          if (noError) {
+            noError = false;
+            errorMsg = fileErrorMsg;
+          }
+        }
+      }
+    );
+    return noError;
+  }
+
+  bool PexAnonymizer::anonymizeDirectory(const std::wstring& directory, size_t& fileCount, std::wstring& errorMsg) {
+    std::vector<std::wstring> filePaths;
+    std::error_code errorCode;
+    for (auto iter = std::filesystem::recursive_directory_iterator(directory, errorCode); !errorCode && iter != std::filesystem::recursive_directory_iterator(); iter.increment(errorCode)) {
+      if (iter->is_regular_file(errorCode) && utility::compare(iter->path().extension().wstring(), L".pex")) {
+        filePaths.push_back(iter->path().wstring());
+      }
+    }
+    if (errorCode) {
+      errorMsg = L"Failed to list files in " + directory;
+      return false;
+    }
+
+    fileCount = filePaths.size();
+    return anonymize(filePaths, errorMsg);
+  }
+
+  bool PexAnonymizer::anonymizeContent(unsigned char* data, size_t size) noexcept {
+    if (size < SCRIPT_PATH_OFFSET || (std::memcmp(data, "\xFA\x57\xC0\xDE", 4) != 0 && std::memcmp(data, "\xDE\xC0\x57\xFA", 4) != 0)) {
+      return false;
+    }
+    bool isBigEndian = (data[0] == 0xFA);
+
+    // Validate all fields before touching any of them, so a truncated file is left as is.
+    size_t fieldOffsets[ANONYMIZED_FIELD_COUNT] {};
+    size_t fieldSizes[ANONYMIZED_FIELD_COUNT] {};
+    size_t offset = SCRIPT_PATH_OFFSET;
+    for (int i = 0; i < ANONYMIZED_FIELD_COUNT; ++i) {
+      if (size - offset < 2) {
+        return false;
+      }
+      fieldSizes[i] = isBigEndian ? (data[offset] << 8 | data[offset + 1]) : (data[offset + 1] << 8 | data[offset]);
+      fieldOffsets[i] = offset + 2;
+      if (size - fieldOffsets[i] < fieldSizes[i]) {
+        return false;
+      }
+      offset = fieldOffsets[i] + fieldSizes[i];
+    }
+
+    for (int i = 0; i < ANONYMIZED_FIELD_COUNT; ++i) {
+      unsigned char* field = data + fieldOffsets[i];
+      if (std::any_of(field, field + fieldSizes[i], [](unsigned char ch) { return ch != '-'; })) {
+        std::memset(field, '-', fieldSizes[i]);
+      }
+    }
+    return true;
+  }
+
+} // namespace
@@ -0,0 +1,45 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace papyrus {
+
+  // Removes personal information PapyrusCompiler stores in generated PEX files. In case you are not aware, user account and
+  // machine name are stored in the header, and in FO4's case, the whole path to the source file is stored there as well.
+  class PexAnonymizer {
+    public:
+      // Anonymize a PEX file in place
+      static bool anonymize(const std::wstring& filePath, std::wstring& errorMsg);
+
+      // Anonymize PEX files in parallel. If any of them fails, the first error message is returned
+      static bool anonymize(const std::vector<std::wstring>& filePaths, std::wstring& errorMsg);
+
+      // Anonymize all PEX files in a directory and its subdirectories in parallel
+      static bool anonymizeDirectory(const std::wstring& directory, size_t& fileCount, std::wstring& errorMsg);
+
+      // Overwrite script path, user name and host name fields in PEX content with dashes. Fields that are already anonymized
+      // are not touched. Returns false if content doesn't have a valid PEX header
+      static bool anonymizeContent(unsigned char* data, size_t size) noexcept;
+  };
+
+} // namespace
@@ -0,0 +1,246 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PexInspectorWindow.hpp"
+
+#include "..\Common\Resources.hpp"
+
+#include "..\..\external\npp\Notepad_plus_msgs.h"
+
+#include <chrono>
+#include <format>
+
+namespace papyrus {
+
+  namespace {
+    std::string formatTime(std::uint64_t time) {
+      return std::format("{:%Y-%m-%d %H:%M:%S} UTC", std::chrono::sys_seconds(std::chrono::seconds(time)));
+    }
+
+    std::string formatUserFlags(const pex::Script& script, std::uint32_t userFlags) {
+      std::string result;
+      for (const auto& userFlag : script.userFlags) {
+        if (userFlag.flagIndex < 32 && (userFlags & (1u << userFlag.flagIndex))) {
+          result += ' ';
+          result += script.string(userFlag.name);
+        }
+      }
+      return result;
+    }
+
+    std::string formatValue(const pex::Script& script, const pex::Value& value) {
+      switch (value.type) {
+        case pex::ValueType::Identifier:
+          return std::string(script.string(value.stringIndex));
+
+        case pex::ValueType::String:
+          return std::format("\"{}\"", script.string(value.stringIndex));
+
+        case pex::ValueType::Integer:
+          return std::to_string(value.integer);
+
+        case pex::ValueType::Float:
+          return std::format("{}", value.floatingPoint);
+
+        case pex::ValueType::Bool:
+          return value.boolean ? "True" : "False";
+
+        default:
+          return "None";
+      }
+    }
+
+    const pex::DebugFunction* findDebugFunction(const pex::Script& script, std::string_view objectName, std::string_view stateName, std::string_view functionName, std::uint8_t functionType) {
+      if (script.debugInfo) {
+        for (const auto& debugFunction : script.debugInfo->functions) {
+          if (debugFunction.functionType == functionType && script.string(debugFunction.functionName) == functionName
+            && script.string(debugFunction.stateName) == stateName && script.string(debugFunction.objectName) == objectName) {
+            return &debugFunction;
+          }
+        }
+      }
+      return nullptr;
+    }
+
+    void formatFunction(std::string& output, const pex::Script& script, std::string_view name, const pex::Function& function, const pex::DebugFunction* debugFunction, std::string_view indent) {
+      output += std::format("{}{} Function {}(", indent, script.string(function.returnType), name);
+      for (size_t i = 0; i < function.parameters.size(); ++i) {
+        output += std::format("{}{} {}", i > 0 ? ", " : "", script.string(function.parameters[i].typeName), script.string(function.parameters[i].name));
+      }
+      output += ')';
+      if (function.flags & 0x01) {
+        output += " Global";
+      }
+      if (function.flags & 0x02) {
+        output += " Native";
+      }
+      output += formatUserFlags(script, function.userFlags) + "\r\n";
+
+      for (const auto& local : function.locals) {
+        output += std::format("{}  ; local {} {}\r\n", indent, script.string(local.typeName), script.string(local.name));
+      }
+      for (size_t i = 0; i < function.instructions.size(); ++i) {
+        const auto& instruction = function.instructions[i];
+        std::string line = std::format("{}  {:04}  {:<18}", indent, i, pex::getOpCodeName(instruction.opCode));
+        for (size_t j = 0; j < instruction.arguments.size(); ++j) {
+          line += (j > 0 ? ", " : " ") + formatValue(script, instruction.arguments[j]);
+        }
+        if (debugFunction && i < debugFunction->lineNumbers.size()) {
+          line = std::format("{:<60} ; line {}", line, debugFunction->lineNumbers[i]);
+        }
+        output += line + "\r\n";
+      }
+    }
+  }
+
+  PexInspectorWindow::PexInspectorWindow(HINSTANCE instance, HWND parent)
+   : DockingDlgInterface(IDD_PEX_INSPECTOR_WINDOW) {
+    DockingDlgInterface::init(instance, parent);
+    tTbData data {
+      .pszName = L"Papyrus PEX Inspector",
+      .dlgID = -1,
+      .uMask = DWS_DF_CONT_RIGHT,
+      .pszModuleName = L"Papyrus.dll"
+    };
+    create(&data);
+    ::SendMessage(parent, NPPM_DMMREGASDCKDLG, 0, reinterpret_cast<LPARAM>(&data));
+    display(false);
+    textBox = ::GetDlgItem(getHSelf(), IDC_PEX_INSPECTOR_TEXT);
+    ::SendMessage(textBox, WM_SETFONT, reinterpret_cast<WPARAM>(::GetStockObject(ANSI_FIXED_FONT)), FALSE);
+    ::SendMessage(textBox, EM_SETLIMITTEXT, 0, 0); // Disassembly of a large script easily exceeds default limit
+    resize();
+  }
+
+  void PexInspectorWindow::show(const std::wstring& filePath, const pex::Script& script) {
+    std::string text = format(script);
+    std::wstring wideText(filePath + L"\r\n\r\n");
+    int length = ::MultiByteToWideChar(CP_ACP, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+    size_t prefixLength = wideText.size();
+    wideText.resize(prefixLength + length);
+    ::MultiByteToWideChar(CP_ACP, 0, text.data(), static_cast<int>(text.size()), wideText.data() + prefixLength, length);
+    ::SetWindowText(textBox, wideText.c_str());
+    display();
+  }
+
+  std::string PexInspectorWindow::format(const pex::Script& script) {
+    const auto& header = script.header;
+    std::string output = std::format("Source:      {}\r\n", header.sourceFileName);
+    output += std::format("Compiled:    {} by {} on {}\r\n", formatTime(header.compilationTime), header.userName, header.machineName);
+    output += std::format("Version:     {}.{}, game ID {}, {} endian\r\n", header.majorVersion, header.minorVersion, header.gameID, header.isBigEndian ? "big" : "little");
+    output += std::format("Strings:     {}\r\n", script.stringTable.size());
+    if (script.debugInfo) {
+      output += std::format("Debug info:  {} function(s), source modified {}\r\n", script.debugInfo->functions.size(), formatTime(script.debugInfo->modificationTime));
+    } else {
+      output += "Debug info:  none\r\n";
+    }
+    if (!script.userFlags.empty()) {
+      output += "User flags: ";
+      for (const auto& userFlag : script.userFlags) {
+        output += std::format(" {}({})", script.string(userFlag.name), userFlag.flagIndex);
+      }
+      output += "\r\n";
+    }
+
+    for (const auto& object : script.objects) {
+      std::string_view objectName = script.string(object.name);
+      output += std::format("\r\nScriptName {}", objectName);
+      if (!script.string(object.parentClassName).empty()) {
+        output += std::format(" extends {}", script.string(object.parentClassName));
+      }
+      if (object.isConst) {
+        output += " Const";
+      }
+      output += formatUserFlags(script, object.userFlags) + "\r\n";
+      if (!script.string(object.docString).empty()) {
+        output += std::format("{{ {} }}\r\n", script.string(object.docString));
+      }
+
+      for (const auto& structInfo : object.structs) {
+        output += std::format("\r\n  Struct {}\r\n", script.string(structInfo.name));
+        for (const auto& member : structInfo.members) {
+          output += std::format("    {} {} = {}\r\n", script.string(member.variable.typeName), script.string(member.variable.name), formatValue(script, member.variable.value));
+        }
+        output += "  EndStruct\r\n";
+      }
+
+      if (!object.variables.empty()) {
+        output += "\r\n";
+      }
+      for (const auto& variable : object.variables) {
+        output += std::format("  {} {} = {}{}{}\r\n", script.string(variable.typeName), script.string(variable.name), formatValue(script, variable.value),
+          variable.isConst ? " Const" : "", formatUserFlags(script, variable.userFlags));
+      }
+
+      for (const auto& property : object.properties) {
+        std::string_view propertyName = script.string(property.name);
+        output += std::format("\r\n  {} Property {}", script.string(property.typeName), propertyName);
+        if (property.flags & 0x04) {
+          output += std::format(" Auto ; {}", script.string(property.autoVariableName));
+        }
+        output += formatUserFlags(script, property.userFlags) + "\r\n";
+        if (property.readHandler) {
+          formatFunction(output, script, "Get", *property.readHandler, findDebugFunction(script, objectName, "", propertyName, 1), "    ");
+        }
+        if (property.writeHandler) {
+          formatFunction(output, script, "Set", *property.writeHandler, findDebugFunction(script, objectName, "", propertyName, 2), "    ");
+        }
+      }
+
+      for (const auto& state : object.states) {
+        std::string_view stateName = script.string(state.name);
+        if (stateName.empty()) {
+          output += "\r\n  ; Empty state\r\n";
+        } else {
+          output += std::format("\r\n  {}State {}\r\n", state.name == object.autoStateName ? "Auto " : "", stateName);
+        }
+        for (const auto& namedFunction : state.functions) {
+          std::string_view functionName = script.string(namedFunction.name);
+          formatFunction(output, script, functionName, namedFunction.function, findDebugFunction(script, objectName, stateName, functionName, 0), "    ");
+        }
+      }
+    }
+    return output;
+  }
+
+  // Protected methods
+  //
+
+  INT_PTR CALLBACK PexInspectorWindow::run_dlgProc(UINT message, WPARAM wParam, LPARAM lParam) {
+    switch (message) {
+      case WM_SIZE: {
+        resize();
+        return 0;
+      }
+
+      default: {
+        return DockingDlgInterface::run_dlgProc(message, wParam, lParam);
+      }
+    }
+  }
+
+  // Private methods
+  //
+
+  void PexInspectorWindow::resize() const {
+    RECT windowSize {};
+    ::GetClientRect(getHSelf(), &windowSize);
+    ::SetWindowPos(textBox, HWND_TOP, 2, 2, windowSize.right - windowSize.left - 4, windowSize.bottom - windowSize.top - 2, 0);
+  }
+
+} // namespace
@@ -0,0 +1,55 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "PexReader.hpp"
+
+#include "..\..\external\npp\DockingDlgInterface.h"
+#include "..\..\external\npp\PluginInterface.h"
+
+#include <string>
+
+#include <windows.h>
+
+namespace papyrus {
+
+  // Docking panel showing header, debug info and disassembly of a compiled script.
+  class PexInspectorWindow : public DockingDlgInterface {
+    public:
+      PexInspectorWindow(HINSTANCE instance, HWND parent);
+
+      void show(const std::wstring& filePath, const pex::Script& script);
+      inline void hide() { display(false); }
+
+      // Text dump of a parsed script, with lines separated by CRLF
+      static std::string format(const pex::Script& script);
+
+    protected:
+      INT_PTR CALLBACK run_dlgProc(UINT message, WPARAM wParam, LPARAM lParam) override;
+
+    private:
+      void resize() const;
+
+      // Private members
+      //
+      HWND textBox;
+  };
+
+} // namespace
@@ -0,0 +1,148 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PexOutputKeeper.hpp"
+
+#include "..\Common\FileSystemUtil.hpp"
+#include "..\Common\MemoryMappedFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <execution>
+
+#include <windows.h>
+
+namespace papyrus {
+
+  namespace {
+    // See PexAnonymizer for header layout. Header is followed by string table (2 bytes count, then each string with 2 bytes size),
+    // and debug info flag (1 byte). If debug info is present, it starts with source file's modification time (8 bytes).
+    constexpr size_t COMPILATION_TIME_OFFSET = 8;
+    constexpr size_t SCRIPT_PATH_OFFSET = 16;
+    constexpr int HEADER_STRING_COUNT = 3; // Script path, user name and host name
+    constexpr size_t MODIFICATION_TIME_SIZE = 8;
+    constexpr const wchar_t* PREVIOUS_OUTPUT_SUFFIX = L".previous";
+
+    // Offsets of the parts of PEX content that are compared, i.e. from the end of header to source file's modification time,
+    // and from the end of modification time to the end of content.
+    struct ComparedParts {
+      size_t bodyOffset {0};
+      size_t modificationTimeOffset {0};
+      size_t modificationTimeEnd {0};
+    };
+
+    bool getComparedParts(std::string_view content, ComparedParts& parts) noexcept {
+      const auto* data = reinterpret_cast<const unsigned char*>(content.data());
+      size_t size = content.size();
+      if (size < SCRIPT_PATH_OFFSET || (std::memcmp(data, "\xFA\x57\xC0\xDE", 4) != 0 && std::memcmp(data, "\xDE\xC0\x57\xFA", 4) != 0)) {
+        return false;
+      }
+      bool isBigEndian = (data[0] == 0xFA);
+      auto readUInt16 = [&](size_t offset) { return static_cast<size_t>(isBigEndian ? (data[offset] << 8 | data[offset + 1]) : (data[offset + 1] << 8 | data[offset])); };
+
+      size_t offset = SCRIPT_PATH_OFFSET;
+      for (int i = 0; i < HEADER_STRING_COUNT; ++i) {
+        if (size - offset < 2 || size - offset - 2 < readUInt16(offset)) {
+          return false;
+        }
+        offset += 2 + readUInt16(offset);
+      }
+      parts.bodyOffset = offset;
+
+      if (size - offset < 2) {
+        return false;
+      }
+      size_t stringCount = readUInt16(offset);
+      offset += 2;
+      for (size_t i = 0; i < stringCount; ++i) {
+        if (size - offset < 2 || size - offset - 2 < readUInt16(offset)) {
+          return false;
+        }
+        offset += 2 + readUInt16(offset);
+      }
+
+      if (size - offset < 1) {
+        return false;
+      }
+      bool hasDebugInfo = (data[offset++] != 0);
+      parts.modificationTimeOffset = offset;
+      parts.modificationTimeEnd = hasDebugInfo ? std::min(offset + MODIFICATION_TIME_SIZE, size) : offset;
+      return true;
+    }
+  }
+
+  PexOutputKeeper::PexOutputKeeper(const std::vector<std::wstring>& outputFiles) {
+    for (const auto& outputFile : outputFiles) {
+      Output& output = outputs.emplace_back(Output {
+        .filePath = outputFile,
+        .previousFilePath = outputFile + PREVIOUS_OUTPUT_SUFFIX
+      });
+      output.isMovedAside = (::MoveFileEx(output.filePath.c_str(), output.previousFilePath.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE);
+    }
+  }
+
+  PexOutputKeeper::~PexOutputKeeper() {
+    for (const auto& output : outputs) {
+      if (output.isMovedAside) {
+        if (utility::fileExists(output.filePath)) {
+          ::DeleteFile(output.previousFilePath.c_str());
+        } else {
+          ::MoveFileEx(output.previousFilePath.c_str(), output.filePath.c_str(), MOVEFILE_REPLACE_EXISTING);
+        }
+      }
+    }
+  }
+
+  void PexOutputKeeper::keepUnchanged() {
+    std::for_each(std::execution::par, outputs.begin(), outputs.end(),
+      [](Output& output) {
+        if (!output.isMovedAside) {
+          return;
+        }
+
+        bool isSame = false;
+        {
+          // Both files need to be unmapped before previous output can replace the new one.
+          utility::MemoryMappedFile file;
+          utility::MemoryMappedFile previousFile;
+          std::wstring errorMsg;
+          isSame = file.open(output.filePath, false, errorMsg) && previousFile.open(output.previousFilePath, false, errorMsg)
+            && isSameContent(file.content(), previousFile.content());
+        }
+        if (isSame && ::MoveFileEx(output.previousFilePath.c_str(), output.filePath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+          output.isMovedAside = false;
+        }
+      }
+    );
+  }
+
+  bool PexOutputKeeper::isSameContent(std::string_view content1, std::string_view content2) noexcept {
+    ComparedParts parts1;
+    ComparedParts parts2;
+    if (!getComparedParts(content1, parts1) || !getComparedParts(content2, parts2)) {
+      return false;
+    }
+
+    // Signature, version and game ID are compared as well.
+    return content1.substr(0, COMPILATION_TIME_OFFSET) == content2.substr(0, COMPILATION_TIME_OFFSET)
+      && content1.substr(parts1.bodyOffset, parts1.modificationTimeOffset - parts1.bodyOffset) == content2.substr(parts2.bodyOffset, parts2.modificationTimeOffset - parts2.bodyOffset)
+      && content1.substr(parts1.modificationTimeEnd) == content2.substr(parts2.modificationTimeEnd);
+  }
+
+} // namespace
@@ -0,0 +1,58 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace papyrus {
+
+  // Keeps existing PEX files when recompiling scripts generates the same code, so their modification time doesn't change and
+  // downstream tools, e.g. archive packers and deploy syncs, don't pick them up for nothing.
+  class PexOutputKeeper {
+    public:
+      // Move existing output files aside, before they are overwritten by compiler or restored from output cache
+      explicit PexOutputKeeper(const std::vector<std::wstring>& outputFiles);
+
+      // Previous outputs are put back if there are no new outputs, e.g. when compilation fails or is cancelled, and removed otherwise
+      ~PexOutputKeeper();
+
+      // Disable all copy/move constructors/assignment operators
+      PexOutputKeeper(PexOutputKeeper&& other) = delete;
+
+      // Compare new outputs with previous ones in parallel, and put back previous outputs that have the same content
+      void keepUnchanged();
+
+      // Check if two PEX contents have the same code. Compilation time and anonymized fields in header, as well as source file's
+      // modification time in debug info, are ignored. Returns false if either one is not a valid PEX content
+      static bool isSameContent(std::string_view content1, std::string_view content2) noexcept;
+
+    private:
+      struct Output {
+        std::wstring filePath;
+        std::wstring previousFilePath;
+        bool isMovedAside {false};
+      };
+
+      std::vector<Output> outputs;
+  };
+
+} // namespace
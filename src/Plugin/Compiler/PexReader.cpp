@@ -0,0 +1,485 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PexReader.hpp"
+
+#include "..\Common\StringUtil.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <execution>
+#include <filesystem>
+#include <mutex>
+
+namespace papyrus {
+
+  namespace {
+    struct OpCodeInfo {
+      std::string_view name;
+      std::uint8_t argumentCount;
+      bool hasVariableArguments;
+    };
+
+    // Op codes 0x00-0x23 are shared by all games, the rest are FO4 only.
+    constexpr OpCodeInfo opCodes[] {
+      {"nop", 0, false},
+      {"iadd", 3, false},
+      {"fadd", 3, false},
+      {"isub", 3, false},
+      {"fsub", 3, false},
+      {"imul", 3, false},
+      {"fmul", 3, false},
+      {"idiv", 3, false},
+      {"fdiv", 3, false},
+      {"imod", 3, false},
+      {"not", 2, false},
+      {"ineg", 2, false},
+      {"fneg", 2, false},
+      {"assign", 2, false},
+      {"cast", 2, false},
+      {"cmp_eq", 3, false},
+      {"cmp_lt", 3, false},
+      {"cmp_le", 3, false},
+      {"cmp_gt", 3, false},
+      {"cmp_ge", 3, false},
+      {"jmp", 1, false},
+      {"jmpt", 2, false},
+      {"jmpf", 2, false},
+      {"callmethod", 3, true},
+      {"callparent", 2, true},
+      {"callstatic", 3, true},
+      {"return", 1, false},
+      {"strcat", 3, false},
+      {"propget", 3, false},
+      {"propset", 3, false},
+      {"array_create", 2, false},
+      {"array_length", 2, false},
+      {"array_getelement", 3, false},
+      {"array_setelement", 3, false},
+      {"array_findelement", 4, false},
+      {"array_rfindelement", 4, false},
+      {"is", 3, false},
+      {"struct_create", 1, false},
+      {"struct_get", 3, false},
+      {"struct_set", 3, false},
+      {"array_findstruct", 5, false},
+      {"array_rfindstruct", 5, false},
+      {"array_add", 3, false},
+      {"array_insert", 3, false},
+      {"array_removelast", 1, false},
+      {"array_remove", 3, false},
+      {"array_clear", 1, false}
+    };
+    constexpr std::uint8_t SKYRIM_OPCODE_COUNT = 0x24;
+
+    // Minimum sizes of repeated items, used to reject garbage counts early
+    constexpr size_t MIN_STRING_SIZE = 2;
+    constexpr size_t MIN_VALUE_SIZE = 1;
+    constexpr size_t MIN_FUNCTION_SIZE = 15;
+    constexpr size_t MIN_OBJECT_SIZE = 20;
+  }
+
+  namespace pex {
+
+    std::string_view getOpCodeName(std::uint8_t opCode) noexcept {
+      return opCode < std::size(opCodes) ? opCodes[opCode].name : std::string_view("<unknown>");
+    }
+
+  } // namespace pex
+
+  bool PexReader::read(const std::wstring& filePath, pex::Script& script, std::wstring& errorMsg) {
+    auto file = std::make_unique<utility::MemoryMappedFile>();
+    if (!file->open(filePath, false, errorMsg)) {
+      return false;
+    }
+
+    if (!read(file->content(), script, errorMsg)) {
+      errorMsg += L": " + filePath;
+      return false;
+    }
+    script.file = std::move(file);
+    return true;
+  }
+
+  bool PexReader::read(std::string_view content, pex::Script& script, std::wstring& errorMsg) {
+    PexReader reader(content);
+    try {
+      if (reader.readScript(script)) {
+        return true;
+      }
+    } catch (const std::bad_alloc&) {
+      reader.failed = true;
+    }
+
+    errorMsg = (reader.pos == 0 ? L"Unknown PEX file format" : L"Corrupted PEX file at offset " + std::to_wstring(reader.pos));
+    return false;
+  }
+
+  std::vector<std::pair<std::wstring, std::wstring>> PexReader::verifyDirectory(const std::wstring& directory, size_t& fileCount) {
+    std::vector<std::pair<std::wstring, std::wstring>> invalidFiles;
+    std::vector<std::wstring> filePaths;
+    std::error_code errorCode;
+    for (auto iter = std::filesystem::recursive_directory_iterator(directory, errorCode); !errorCode && iter != std::filesystem::recursive_directory_iterator(); iter.increment(errorCode)) {
+      if (iter->is_regular_file(errorCode) && utility::compare(iter->path().extension().wstring(), L".pex")) {
+        filePaths.push_back(iter->path().wstring());
+      }
+    }
+    if (errorCode) {
+      invalidFiles.emplace_back(directory, L"Failed to list files");
+    }
+
+    std::mutex resultMutex;
+    std::for_each(std::execution::par, filePaths.begin(), filePaths.end(),
+      [&](const auto& filePath) {
+        pex::Script script;
+        std::wstring errorMsg;
+        if (!read(filePath, script, errorMsg)) {
+          std::lock_guard<std::mutex> lock(resultMutex);
+          invalidFiles.emplace_back(filePath, errorMsg);
+        }
+      }
+    );
+    std::sort(invalidFiles.begin(), invalidFiles.end());
+
+    fileCount = filePaths.size();
+    return invalidFiles;
+  }
+
+  // Private methods
+  //
+
+  bool PexReader::readScript(pex::Script& script) {
+    if (content.size() < 4 || (std::memcmp(content.data(), "\xFA\x57\xC0\xDE", 4) != 0 && std::memcmp(content.data(), "\xDE\xC0\x57\xFA", 4) != 0)) {
+      return false;
+    }
+    isBigEndian = (static_cast<unsigned char>(content[0]) == 0xFA);
+    isFallout4 = !isBigEndian;
+    pos = 4;
+
+    // Header
+    script.header = pex::Header {
+      .isBigEndian = isBigEndian,
+      .majorVersion = readUInt8(),
+      .minorVersion = readUInt8(),
+      .gameID = readUInt16(),
+      .compilationTime = readUInt64(),
+      .sourceFileName = readString(),
+      .userName = readString(),
+      .machineName = readString()
+    };
+
+    // String table
+    std::uint16_t count = readUInt16();
+    if (!canFit(count, MIN_STRING_SIZE)) {
+      return false;
+    }
+    script.stringTable.reserve(count);
+    for (std::uint16_t i = 0; i < count && !failed; ++i) {
+      script.stringTable.push_back(readString());
+    }
+
+    // Debug info
+    if (readUInt8() != 0) {
+      pex::DebugInfo& debugInfo = script.debugInfo.emplace();
+      debugInfo.modificationTime = readUInt64();
+
+      count = readUInt16();
+      for (std::uint16_t i = 0; i < count && canFit(1, 9); ++i) {
+        pex::DebugFunction& function = debugInfo.functions.emplace_back();
+        function.objectName = readUInt16();
+        function.stateName = readUInt16();
+        function.functionName = readUInt16();
+        function.functionType = readUInt8();
+        std::uint16_t instructionCount = readUInt16();
+        if (canFit(instructionCount, 2)) {
+          function.lineNumbers.reserve(instructionCount);
+          for (std::uint16_t j = 0; j < instructionCount; ++j) {
+            function.lineNumbers.push_back(readUInt16());
+          }
+        }
+      }
+
+      if (isFallout4) {
+        count = readUInt16();
+        for (std::uint16_t i = 0; i < count && canFit(1, 12); ++i) {
+          pex::PropertyGroup& group = debugInfo.propertyGroups.emplace_back();
+          group.objectName = readUInt16();
+          group.groupName = readUInt16();
+          group.docString = readUInt16();
+          group.userFlags = readUInt32();
+          std::uint16_t propertyCount = readUInt16();
+          for (std::uint16_t j = 0; j < propertyCount && canFit(1, 2); ++j) {
+            group.propertyNames.push_back(readUInt16());
+          }
+        }
+
+        count = readUInt16();
+        for (std::uint16_t i = 0; i < count && canFit(1, 6); ++i) {
+          pex::StructOrder& order = debugInfo.structOrders.emplace_back();
+          order.objectName = readUInt16();
+          order.orderName = readUInt16();
+          std::uint16_t variableCount = readUInt16();
+          for (std::uint16_t j = 0; j < variableCount && canFit(1, 2); ++j) {
+            order.variableNames.push_back(readUInt16());
+          }
+        }
+      }
+    }
+
+    // User flags
+    count = readUInt16();
+    for (std::uint16_t i = 0; i < count && canFit(1, 3); ++i) {
+      script.userFlags.push_back(pex::UserFlag {
+        .name = readUInt16(),
+        .flagIndex = readUInt8()
+      });
+    }
+
+    // Objects
+    count = readUInt16();
+    for (std::uint16_t i = 0; i < count && canFit(1, MIN_OBJECT_SIZE); ++i) {
+      script.objects.push_back(readObject());
+    }
+
+    return !failed;
+  }
+
+  std::uint8_t PexReader::readUInt8() noexcept {
+    if (failed || content.size() - pos < 1) {
+      failed = true;
+      return 0;
+    }
+    return static_cast<std::uint8_t>(content[pos++]);
+  }
+
+  std::uint16_t PexReader::readUInt16() noexcept {
+    if (failed || content.size() - pos < 2) {
+      failed = true;
+      return 0;
+    }
+    std::uint16_t value;
+    std::memcpy(&value, content.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return isBigEndian ? std::byteswap(value) : value;
+  }
+
+  std::uint32_t PexReader::readUInt32() noexcept {
+    if (failed || content.size() - pos < 4) {
+      failed = true;
+      return 0;
+    }
+    std::uint32_t value;
+    std::memcpy(&value, content.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return isBigEndian ? std::byteswap(value) : value;
+  }
+
+  std::uint64_t PexReader::readUInt64() noexcept {
+    if (failed || content.size() - pos < 8) {
+      failed = true;
+      return 0;
+    }
+    std::uint64_t value;
+    std::memcpy(&value, content.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return isBigEndian ? std::byteswap(value) : value;
+  }
+
+  std::string_view PexReader::readString() noexcept {
+    std::uint16_t length = readUInt16();
+    if (failed || content.size() - pos < length) {
+      failed = true;
+      return std::string_view();
+    }
+    std::string_view value = content.substr(pos, length);
+    pos += length;
+    return value;
+  }
+
+  pex::Value PexReader::readValue() noexcept {
+    pex::Value value {
+      .type = static_cast<pex::ValueType>(readUInt8())
+    };
+    switch (value.type) {
+      case pex::ValueType::Null:
+        break;
+
+      case pex::ValueType::Identifier:
+      case pex::ValueType::String:
+        value.stringIndex = readUInt16();
+        break;
+
+      case pex::ValueType::Integer:
+        value.integer = static_cast<std::int32_t>(readUInt32());
+        break;
+
+      case pex::ValueType::Float:
+        value.floatingPoint = std::bit_cast<float>(readUInt32());
+        break;
+
+      case pex::ValueType::Bool:
+        value.boolean = (readUInt8() != 0);
+        break;
+
+      default:
+        failed = true;
+        break;
+    }
+    return value;
+  }
+
+  pex::Variable PexReader::readVariable() {
+    pex::Variable variable {
+      .name = readUInt16(),
+      .typeName = readUInt16(),
+      .userFlags = readUInt32(),
+      .value = readValue()
+    };
+    if (isFallout4) {
+      variable.isConst = (readUInt8() != 0);
+    }
+    return variable;
+  }
+
+  pex::Function PexReader::readFunction() {
+    pex::Function function {
+      .returnType = readUInt16(),
+      .docString = readUInt16(),
+      .userFlags = readUInt32(),
+      .flags = readUInt8()
+    };
+
+    std::uint16_t count = readUInt16();
+    for (std::uint16_t i = 0; i < count && canFit(1, 4); ++i) {
+      function.parameters.push_back(pex::NameTypePair { .name = readUInt16(), .typeName = readUInt16() });
+    }
+
+    count = readUInt16();
+    for (std::uint16_t i = 0; i < count && canFit(1, 4); ++i) {
+      function.locals.push_back(pex::NameTypePair { .name = readUInt16(), .typeName = readUInt16() });
+    }
+
+    count = readUInt16();
+    if (canFit(count, 1)) {
+      function.instructions.reserve(count);
+    }
+    for (std::uint16_t i = 0; i < count && canFit(1, 1); ++i) {
+      pex::Instruction& instruction = function.instructions.emplace_back();
+      instruction.opCode = readUInt8();
+      if (instruction.opCode >= (isFallout4 ? std::size(opCodes) : SKYRIM_OPCODE_COUNT)) {
+        failed = true;
+        break;
+      }
+
+      const OpCodeInfo& opCodeInfo = opCodes[instruction.opCode];
+      for (std::uint8_t j = 0; j < opCodeInfo.argumentCount; ++j) {
+        instruction.arguments.push_back(readValue());
+      }
+      if (opCodeInfo.hasVariableArguments) {
+        // Number of variable arguments is stored as an integer value, followed by the arguments.
+        pex::Value argumentCount = readValue();
+        if (argumentCount.type != pex::ValueType::Integer || argumentCount.integer < 0 || !canFit(argumentCount.integer, MIN_VALUE_SIZE)) {
+          failed = true;
+          break;
+        }
+        instruction.arguments.push_back(argumentCount);
+        for (std::int32_t j = 0; j < argumentCount.integer; ++j) {
+          instruction.arguments.push_back(readValue());
+        }
+      }
+    }
+    return function;
+  }
+
+  pex::Object PexReader::readObject() {
+    pex::Object object {
+      .name = readUInt16()
+    };
+    readUInt32(); // Size of object data, not needed as every field is parsed
+    object.parentClassName = readUInt16();
+    object.docString = readUInt16();
+    if (isFallout4) {
+      object.isConst = (readUInt8() != 0);
+    }
+    object.userFlags = readUInt32();
+    object.autoStateName = readUInt16();
+
+    if (isFallout4) {
+      std::uint16_t count = readUInt16();
+      for (std::uint16_t i = 0; i < count && canFit(1, 4); ++i) {
+        pex::Struct& structInfo = object.structs.emplace_back();
+        structInfo.name = readUInt16();
+        std::uint16_t memberCount = readUInt16();
+        for (std::uint16_t j = 0; j < memberCount && canFit(1, 12); ++j) {
+          pex::StructMember& member = structInfo.members.emplace_back();
+          member.variable = readVariable();
+          member.docString = readUInt16();
+        }
+      }
+    }
+
+    std::uint16_t count = readUInt16();
+    for (std::uint16_t i = 0; i < count && canFit(1, 9); ++i) {
+      object.variables.push_back(readVariable());
+    }
+
+    count = readUInt16();
+    for (std::uint16_t i = 0; i < count && canFit(1, 11); ++i) {
+      pex::Property& property = object.properties.emplace_back();
+      property.name = readUInt16();
+      property.typeName = readUInt16();
+      property.docString = readUInt16();
+      property.userFlags = readUInt32();
+      property.flags = readUInt8();
+      if (property.flags & 0x04) {
+        property.autoVariableName = readUInt16();
+      } else {
+        if (property.flags & 0x01) {
+          property.readHandler = readFunction();
+        }
+        if (property.flags & 0x02) {
+          property.writeHandler = readFunction();
+        }
+      }
+    }
+
+    count = readUInt16();
+    for (std::uint16_t i = 0; i < count && canFit(1, 4); ++i) {
+      pex::State& state = object.states.emplace_back();
+      state.name = readUInt16();
+      std::uint16_t functionCount = readUInt16();
+      for (std::uint16_t j = 0; j < functionCount && canFit(1, MIN_FUNCTION_SIZE); ++j) {
+        state.functions.push_back(pex::NamedFunction {
+          .name = readUInt16(),
+          .function = readFunction()
+        });
+      }
+    }
+    return object;
+  }
+
+  bool PexReader::canFit(size_t count, size_t minItemSize) noexcept {
+    if (!failed && (content.size() - pos) / minItemSize < count) {
+      failed = true;
+    }
+    return !failed;
+  }
+
+} // namespace
@@ -0,0 +1,230 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "..\Common\MemoryMappedFile.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace papyrus {
+
+  namespace pex {
+
+    // Most fields refer to strings by their index in string table
+    using string_index_t = std::uint16_t;
+
+    enum class ValueType : std::uint8_t {
+      Null,
+      Identifier,
+      String,
+      Integer,
+      Float,
+      Bool
+    };
+
+    struct Value {
+      ValueType type {ValueType::Null};
+      string_index_t stringIndex {0}; // Identifier or String
+      std::int32_t integer {0};
+      float floatingPoint {0};
+      bool boolean {false};
+    };
+
+    struct Instruction {
+      std::uint8_t opCode {0};
+      std::vector<Value> arguments; // Including variable arguments of call instructions
+    };
+
+    struct NameTypePair {
+      string_index_t name {0};
+      string_index_t typeName {0};
+    };
+
+    struct Function {
+      string_index_t returnType {0};
+      string_index_t docString {0};
+      std::uint32_t userFlags {0};
+      std::uint8_t flags {0}; // 0x01: global, 0x02: native
+      std::vector<NameTypePair> parameters;
+      std::vector<NameTypePair> locals;
+      std::vector<Instruction> instructions;
+    };
+
+    struct NamedFunction {
+      string_index_t name {0};
+      Function function;
+    };
+
+    struct State {
+      string_index_t name {0};
+      std::vector<NamedFunction> functions;
+    };
+
+    struct Variable {
+      string_index_t name {0};
+      string_index_t typeName {0};
+      std::uint32_t userFlags {0};
+      Value value;
+      bool isConst {false}; // FO4 only
+    };
+
+    struct StructMember {
+      Variable variable;
+      string_index_t docString {0};
+    };
+
+    struct Struct {
+      string_index_t name {0};
+      std::vector<StructMember> members;
+    };
+
+    struct Property {
+      string_index_t name {0};
+      string_index_t typeName {0};
+      string_index_t docString {0};
+      std::uint32_t userFlags {0};
+      std::uint8_t flags {0}; // 0x01: read, 0x02: write, 0x04: auto
+      string_index_t autoVariableName {0};
+      std::optional<Function> readHandler;
+      std::optional<Function> writeHandler;
+    };
+
+    struct Object {
+      string_index_t name {0};
+      string_index_t parentClassName {0};
+      string_index_t docString {0};
+      bool isConst {false}; // FO4 only
+      std::uint32_t userFlags {0};
+      string_index_t autoStateName {0};
+      std::vector<Struct> structs; // FO4 only
+      std::vector<Variable> variables;
+      std::vector<Property> properties;
+      std::vector<State> states;
+    };
+
+    struct DebugFunction {
+      string_index_t objectName {0};
+      string_index_t stateName {0};
+      string_index_t functionName {0};
+      std::uint8_t functionType {0}; // 0: method, 1: property getter, 2: property setter
+      std::vector<std::uint16_t> lineNumbers; // Source line of each instruction
+    };
+
+    struct PropertyGroup {
+      string_index_t objectName {0};
+      string_index_t groupName {0};
+      string_index_t docString {0};
+      std::uint32_t userFlags {0};
+      std::vector<string_index_t> propertyNames;
+    };
+
+    struct StructOrder {
+      string_index_t objectName {0};
+      string_index_t orderName {0};
+      std::vector<string_index_t> variableNames;
+    };
+
+    struct DebugInfo {
+      std::uint64_t modificationTime {0};
+      std::vector<DebugFunction> functions;
+      std::vector<PropertyGroup> propertyGroups; // FO4 only
+      std::vector<StructOrder> structOrders; // FO4 only
+    };
+
+    struct UserFlag {
+      string_index_t name {0};
+      std::uint8_t flagIndex {0};
+    };
+
+    struct Header {
+      bool isBigEndian {false}; // Skyrim & SSE use big endian, FO4 uses little endian
+      std::uint8_t majorVersion {0};
+      std::uint8_t minorVersion {0};
+      std::uint16_t gameID {0};
+      std::uint64_t compilationTime {0};
+      std::string_view sourceFileName;
+      std::string_view userName;
+      std::string_view machineName;
+    };
+
+    // A parsed PEX file. Strings are views into the mapped file, so they are only valid as long as the script is alive.
+    struct Script {
+      Header header;
+      std::vector<std::string_view> stringTable;
+      std::optional<DebugInfo> debugInfo;
+      std::vector<UserFlag> userFlags;
+      std::vector<Object> objects;
+
+      // Resolve a string table index. Out of range indices result in an empty string
+      inline std::string_view string(string_index_t index) const noexcept { return index < stringTable.size() ? stringTable[index] : std::string_view(); }
+
+      std::unique_ptr<utility::MemoryMappedFile> file;
+    };
+
+    // Mnemonic of an instruction's op code, e.g. "iadd"
+    std::string_view getOpCodeName(std::uint8_t opCode) noexcept;
+
+  } // namespace pex
+
+  // Reads all sections of a PEX file, in either byte order, with every read bounds-checked.
+  class PexReader {
+    public:
+      // Map and parse a PEX file. On failure, error message is returned in errorMsg
+      static bool read(const std::wstring& filePath, pex::Script& script, std::wstring& errorMsg);
+
+      // Parse PEX content. Strings in the script refer to the given content
+      static bool read(std::string_view content, pex::Script& script, std::wstring& errorMsg);
+
+      // Parse all PEX files in a directory and its subdirectories in parallel. Returns paths and error messages of invalid files
+      static std::vector<std::pair<std::wstring, std::wstring>> verifyDirectory(const std::wstring& directory, size_t& fileCount);
+
+    private:
+      explicit PexReader(std::string_view content) : content(content) {}
+
+      bool readScript(pex::Script& script);
+      std::uint8_t readUInt8() noexcept;
+      std::uint16_t readUInt16() noexcept;
+      std::uint32_t readUInt32() noexcept;
+      std::uint64_t readUInt64() noexcept;
+      std::string_view readString() noexcept;
+      pex::Value readValue() noexcept;
+      pex::Variable readVariable();
+      pex::Function readFunction();
+      pex::Object readObject();
+
+      // Check that a number of items, each taking at least the given bytes, can fit in remaining content. This prevents huge
+      // allocations caused by garbage counts
+      bool canFit(size_t count, size_t minItemSize) noexcept;
+
+      // Private members
+      //
+      std::string_view content;
+      size_t pos {0};
+      bool isBigEndian {false};
+      bool isFallout4 {false};
+      bool failed {false};
+  };
+
+} // namespace
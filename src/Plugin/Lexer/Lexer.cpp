@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Lexer.hpp"
 
 #include "LexerIDs.hpp"
+#include "Tokenizer.hpp"
 #include "..\Common\FileSystemUtil.hpp"
 #include "..\Common\Logger.hpp"
 #include "..\Common\StringUtil.hpp"
@@ -349,9 +350,24 @@ namespace papyrus {
   std::vector<Lexer::Token> Lexer::tokenize(Accessor& accessor, Sci_Position line) const {
     std::vector<Token> tokens;
     TokenType previousTokenType = TokenType::Special;
-    auto index = accessor.LineStart(line);
+    auto lineStart = accessor.LineStart(line);
+    auto index = lineStart;
     auto indexNext = index;
     int ch = getNextChar(accessor, index, indexNext);
+
+    // Extents of identifiers and numbers are determined by Tokenizer's rules on raw line text. Both only consist of ASCII characters,
+    // so they are the same length in bytes as in characters.
+    std::string lineText = accessor.GetRange(lineStart, accessor.LineEnd(line));
+    auto takeToken = [&](TokenType tokenType, size_t length) {
+      Token token {
+        .content = utility::toLower(lineText.substr(static_cast<size_t>(index - lineStart), length)), // Papyrus script is case insensitive
+        .tokenType = tokenType,
+        .startPos = index
+      };
+      indexNext = index + static_cast<Sci_Position>(length);
+      ch = getNextChar(accessor, index, indexNext);
+      return token;
+    };
     while (index < accessor.LineEnd(line)) {
       if (ch == '\r' || ch == '\n') {
         break;
@@ -362,41 +378,15 @@ namespace papyrus {
         if (std::isblank(ch)) {
           ch = getNextChar(accessor, index, indexNext);
           processed = true;
-        } else if (std::isalpha(ch) || ch == '_') {
-          Token token {
-            .tokenType = TokenType::Identifier,
-            .startPos = index
-          };
-          while (ch <= 255 && (std::isalnum(ch) || ch == '_' || ch == ':')) {
-            token.content.push_back(std::tolower(ch)); // Papyrus script is case insensitive
-            ch = getNextChar(accessor, index, indexNext);
-          }
+        } else if (Tokenizer::isIdentifierStart(ch)) {
+          Token token = takeToken(TokenType::Identifier, Tokenizer::identifierLength(lineText, static_cast<size_t>(index - lineStart)));
           tokens.push_back(token);
           previousTokenType = token.tokenType;
           processed = true;
         } else if (std::isdigit(ch) || (ch == '-' && previousTokenType == TokenType::Special)) { // For a minus sign to be treated as leading minus sign rather than minus operator, previous token cannot be an identifier or a number
-          Token token {
-            .tokenType = TokenType::Numeric,
-            .startPos = index
-          };
-          bool hasDigit = false;
-          while (ch <= 255
-            && (std::isdigit(ch)
-              || (ch == '-' && index == token.startPos) // leading minus sign
-              || (ch == '.' && hasDigit) // decimal point after at least a digit
-              || ((ch == 'x' || ch == 'X') && index == token.startPos + 1 && token.content.front() == '0') // 0x
-              || (std::isxdigit(ch) && token.content.size() > 1 && std::tolower(token.content.at(1)) == 'x'))) { // hex value after 0x
-            token.content.push_back(std::tolower(ch));
-            if (!hasDigit && std::isdigit(ch)) {
-              hasDigit = true;
-            }
-            ch = getNextChar(accessor, index, indexNext);
-          }
-
           // In the case when the token is a single '-', it's not numeric.
-          if (token.content.front() == '-' && token.content.size() == 1) {
-            token.tokenType = TokenType::Special;
-          }
+          size_t length = Tokenizer::numericLength(lineText, static_cast<size_t>(index - lineStart));
+          Token token = takeToken(length > 1 || ch != '-' ? TokenType::Numeric : TokenType::Special, length);
           tokens.push_back(token);
           previousTokenType = token.tokenType;
           processed = true;
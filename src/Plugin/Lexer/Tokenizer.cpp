@@ -0,0 +1,226 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Tokenizer.hpp"
+
+namespace papyrus {
+
+  bool Tokenizer::next(Token& token) noexcept {
+    bool lineEnded = false;
+    while (pos < text.size()) {
+      int ch = charAt(pos);
+      if (ch == '\r' || ch == '\n') {
+        skipLineBreak();
+        previousTokenType = TokenType::Special;
+        if (hasTokenOnLine) {
+          hasTokenOnLine = false;
+          token = Token {
+            .content = text.substr(pos, 0),
+            .tokenType = TokenType::LineEnd,
+            .line = lastTokenLine
+          };
+          return true;
+        }
+      } else if (ch == ' ' || ch == '\t') {
+        pos++;
+      } else if (ch == '\\') {
+        // A backslash followed only by blanks continues current line on the next one.
+        size_t search = pos + 1;
+        while (charAt(search) == ' ' || charAt(search) == '\t') {
+          search++;
+        }
+        if (charAt(search) == '\r' || charAt(search) == '\n' || search >= text.size()) {
+          pos = search;
+          skipLineBreak();
+        } else {
+          break;
+        }
+      } else if (ch == ';') {
+        if (charAt(pos + 1) == '/') {
+          // Multi-line comment, ends with "/;".
+          pos += 2;
+          if (skipBlock("/;") && hasTokenOnLine) {
+            lineEnded = true; // A line break inside the comment ends current line
+            break;
+          }
+        } else {
+          // Comment till the end of line.
+          while (pos < text.size() && charAt(pos) != '\r' && charAt(pos) != '\n') {
+            pos++;
+          }
+        }
+      } else if (ch == '{') {
+        // Documentation comment, ends with "}".
+        pos++;
+        if (skipBlock("}") && hasTokenOnLine) {
+          lineEnded = true;
+          break;
+        }
+      } else {
+        break;
+      }
+    }
+
+    if (lineEnded || pos >= text.size()) {
+      if (hasTokenOnLine) {
+        hasTokenOnLine = false;
+        previousTokenType = TokenType::Special;
+        token = Token {
+          .content = text.substr(pos, 0),
+          .tokenType = TokenType::LineEnd,
+          .line = lastTokenLine
+        };
+        return true;
+      }
+      return false;
+    }
+
+    int ch = charAt(pos);
+    size_t length = 1;
+    TokenType tokenType = TokenType::Special;
+    if (isIdentifierStart(ch)) {
+      tokenType = TokenType::Identifier;
+      length = identifierLength(text, pos);
+    } else if (std::isdigit(ch) || (ch == '-' && previousTokenType == TokenType::Special)) { // For a minus sign to be treated as leading minus sign rather than minus operator, previous token cannot be an identifier or a number
+      length = numericLength(text, pos);
+      if (length > 1 || ch != '-') {
+        tokenType = TokenType::Numeric;
+      } else {
+        length = 1;
+      }
+    } else if (ch == '"') {
+      // String ends with an unescaped double quote, or the end of line.
+      tokenType = TokenType::String;
+      while (pos + length < text.size() && charAt(pos + length) != '\r' && charAt(pos + length) != '\n') {
+        int current = charAt(pos + length);
+        length++;
+        if (current == '\\') {
+          if (pos + length < text.size() && charAt(pos + length) != '\r' && charAt(pos + length) != '\n') {
+            length++;
+          }
+        } else if (current == '"') {
+          break;
+        }
+      }
+    }
+
+    token = Token {
+      .content = text.substr(pos, length),
+      .tokenType = tokenType,
+      .line = line
+    };
+    pos += length;
+    previousTokenType = (tokenType == TokenType::String ? TokenType::Identifier : tokenType);
+    lastTokenLine = line;
+    hasTokenOnLine = true;
+    return true;
+  }
+
+  size_t Tokenizer::identifierLength(std::string_view text, size_t pos) noexcept {
+    size_t length = 0;
+    while (pos + length < text.size() && isIdentifierChar(static_cast<unsigned char>(text[pos + length]))) {
+      length++;
+    }
+    return length;
+  }
+
+  size_t Tokenizer::numericLength(std::string_view text, size_t pos) noexcept {
+    // Numbers are digits, optionally with a leading minus sign and a decimal point, or hex numbers starting with 0[xX].
+    size_t length = 0;
+    bool hasDigit = false;
+    bool isHex = false;
+    while (pos + length < text.size()) {
+      int ch = static_cast<unsigned char>(text[pos + length]);
+      if (std::isdigit(ch)
+        || (ch == '-' && length == 0) // leading minus sign
+        || (ch == '.' && hasDigit) // decimal point after at least a digit
+        || ((ch == 'x' || ch == 'X') && length == 1 && text[pos] == '0') // 0x
+        || (isHex && std::isxdigit(ch))) { // hex value after 0x
+        if (ch == 'x' || ch == 'X') {
+          isHex = true;
+        }
+        if (std::isdigit(ch)) {
+          hasDigit = true;
+        }
+        length++;
+      } else {
+        break;
+      }
+    }
+    return length;
+  }
+
+  size_t Tokenizer::tokenLength(std::string_view text, size_t pos) noexcept {
+    if (pos >= text.size()) {
+      return 0;
+    }
+
+    int ch = static_cast<unsigned char>(text[pos]);
+    if (isIdentifierStart(ch)) {
+      return identifierLength(text, pos);
+    }
+    if (std::isdigit(ch) || ch == '-') {
+      return numericLength(text, pos);
+    }
+    if (std::isspace(ch)) {
+      return 1;
+    }
+
+    size_t length = 0;
+    while (pos + length < text.size() && !std::isalnum(static_cast<unsigned char>(text[pos + length])) && !std::isspace(static_cast<unsigned char>(text[pos + length]))) {
+      length++;
+    }
+    return length;
+  }
+
+  // Private methods
+  //
+
+  bool Tokenizer::skipLineBreak() noexcept {
+    if (charAt(pos) == '\r') {
+      pos++;
+      if (charAt(pos) == '\n') {
+        pos++;
+      }
+    } else if (charAt(pos) == '\n') {
+      pos++;
+    } else {
+      return false;
+    }
+
+    line++;
+    return true;
+  }
+
+  bool Tokenizer::skipBlock(std::string_view terminator) noexcept {
+    size_t startLine = line;
+    while (pos < text.size()) {
+      if (text.substr(pos, terminator.size()) == terminator) {
+        pos += terminator.size();
+        break;
+      }
+
+      if (!skipLineBreak()) {
+        pos++;
+      }
+    }
+    return line != startLine;
+  }
+
+} // namespace
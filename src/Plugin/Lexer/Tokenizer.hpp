@@ -0,0 +1,80 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cctype>
+#include <string_view>
+
+namespace papyrus {
+
+  // A lightweight tokenizer that works on raw script text (UTF-8 or ANSI), e.g. content of a file loaded from disk. It follows the same
+  // rules Lexer uses to split a line into tokens. White spaces, comments and line continuations are skipped, and the end of each logical
+  // line is reported as a separate token.
+  class Tokenizer {
+    public:
+      enum class TokenType {
+        Identifier,
+        Numeric,
+        String,
+        Special,
+        LineEnd
+      };
+
+      struct Token {
+        std::string_view content;
+        TokenType tokenType;
+        size_t line; // Zero-based
+      };
+
+      [[nodiscard]] inline explicit Tokenizer(std::string_view text) noexcept : text(text) {}
+
+      // Retrieve next token. Returns false when the end of text is reached.
+      bool next(Token& token) noexcept;
+
+      // Character classification and token extent rules
+      inline static bool isIdentifierStart(int ch) noexcept { return ch <= 255 && (std::isalpha(ch) || ch == '_'); }
+      inline static bool isIdentifierChar(int ch) noexcept { return ch <= 255 && (std::isalnum(ch) || ch == '_' || ch == ':'); }
+      static size_t identifierLength(std::string_view text, size_t pos) noexcept;
+      static size_t numericLength(std::string_view text, size_t pos) noexcept;
+
+      // Length of the token starting at given position within a line, e.g. to mark where an error is: an identifier, a number, a run of
+      // special characters, or a single blank character. Returns 0 at the end of text.
+      static size_t tokenLength(std::string_view text, size_t pos) noexcept;
+
+    private:
+      inline int charAt(size_t index) const noexcept { return index < text.size() ? static_cast<unsigned char>(text[index]) : 0; }
+
+      // Skip a line break at current position. Returns false if there isn't one.
+      bool skipLineBreak() noexcept;
+
+      // Skip to the end of a block delimited by the given terminator, keeping track of line numbers. Returns true if the block spans lines.
+      bool skipBlock(std::string_view terminator) noexcept;
+
+      // Private members
+      //
+      std::string_view text;
+      size_t pos {0};
+      size_t line {0};
+      size_t lastTokenLine {0};
+      bool hasTokenOnLine {false};
+      TokenType previousTokenType {TokenType::Special};
+  };
+
+} // namespace
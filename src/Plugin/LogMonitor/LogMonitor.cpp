@@ -0,0 +1,339 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// For the time being, as there is no good alternative way in C++17 to get stream working than using codecvt
+#define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
+
+#include "LogMonitor.hpp"
+
+#include "..\Common\FileSystemUtil.hpp"
+#include "..\Common\Resources.hpp"
+#include "..\Common\StringUtil.hpp"
+
+#include "..\..\external\gsl\include\gsl\util"
+#include "..\..\external\npp\Common.h"
+
+#include <algorithm>
+#include <codecvt>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+
+namespace papyrus {
+
+  namespace {
+    constexpr DWORD POLL_INTERVAL = 1000; // In milliseconds
+    constexpr size_t READ_BUFFER_SIZE = 1024 * 1024;
+    constexpr size_t MAX_ERRORS_PER_LOG = 1000;
+
+    std::uint64_t strToUInt64(const std::wstring& str) noexcept {
+      try {
+        return std::stoull(str);
+      } catch (...) {
+        return 0;
+      }
+    }
+  }
+
+  LogMonitor::LogMonitor(HWND messageWindow, const std::wstring& statePath)
+    : messageWindow(messageWindow), statePath(statePath), buffer(READ_BUFFER_SIZE) {
+    stopEvent = ::CreateEvent(nullptr, TRUE, FALSE, nullptr);
+  }
+
+  LogMonitor::~LogMonitor() {
+    stop();
+    ::CloseHandle(stopEvent);
+  }
+
+  void LogMonitor::watch(const std::vector<Log>& logs) {
+    if (logs == watchedLogs && (logs.empty() || monitorThread.joinable())) {
+      return;
+    }
+
+    stop();
+    if (!loaded) {
+      load();
+    }
+
+    for (auto& state : states) {
+      state.watched = false;
+    }
+    for (const auto& log : logs) {
+      auto state = std::find_if(states.begin(), states.end(), [&](const auto& state) { return utility::compare(state.log.path, log.path); });
+      if (state == states.end()) {
+        state = states.emplace(states.end());
+        state->log.path = log.path;
+      }
+      if (state->log.importDirectories != log.importDirectories) {
+        state->log.importDirectories = log.importDirectories;
+        state->sourcePaths.clear();
+      }
+      state->watched = true;
+    }
+    watchedLogs = logs;
+    start();
+  }
+
+  void LogMonitor::forget(const std::vector<std::wstring>& files) {
+    // Worker owns log states while it's running, so it's paused meanwhile.
+    stop();
+    if (!loaded) {
+      load();
+    }
+
+    bool changed = false;
+    for (auto& state : states) {
+      changed |= (std::erase_if(state.errors, [&](const Error& error) {
+        bool isForgotten = std::any_of(files.begin(), files.end(), [&](const auto& file) { return utility::compare(error.file, file); });
+        if (isForgotten) {
+          state.errorKeys.erase(std::format(L"{}|{}|{}", utility::toUpper(error.file), error.line, error.message));
+        }
+        return isForgotten;
+      }) > 0);
+    }
+    if (changed) {
+      save();
+    }
+    start();
+  }
+
+  // Private methods
+  //
+
+  void LogMonitor::start() {
+    if (!watchedLogs.empty() && !monitorThread.joinable()) {
+      try {
+        ::ResetEvent(stopEvent);
+        monitorThread = std::thread([this]() { run(); });
+      } catch (const std::system_error&) {
+        watchedLogs.clear();
+      }
+    }
+  }
+
+  void LogMonitor::run() {
+    do {
+      bool changed = false;
+      for (auto& state : states) {
+        if (!state.watched) {
+          continue;
+        }
+
+        if (!state.posted) {
+          state.posted = true;
+          postErrors(std::vector<Error>(state.errors), true);
+        }
+
+        std::vector<Error> newErrors;
+        changed |= read(state, newErrors);
+        postErrors(std::move(newErrors), false);
+      }
+
+      if (changed) {
+        save();
+      }
+    } while (::WaitForSingleObject(stopEvent, POLL_INTERVAL) == WAIT_TIMEOUT);
+  }
+
+  void LogMonitor::stop() {
+    if (monitorThread.joinable()) {
+      // Worker only posts to message window, so it never waits on current thread.
+      ::SetEvent(stopEvent);
+      monitorThread.join();
+    }
+  }
+
+  bool LogMonitor::read(LogState& state, std::vector<Error>& newErrors) {
+    HANDLE file = ::CreateFile(state.log.path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    auto autoCleanup = gsl::finally([&] { ::CloseHandle(file); });
+
+    BY_HANDLE_FILE_INFORMATION fileInfo {};
+    if (!::GetFileInformationByHandle(file, &fileInfo)) {
+      return false;
+    }
+    std::wstring fileID = std::format(L"{:08X}{:08X}{:08X}", fileInfo.dwVolumeSerialNumber, fileInfo.nFileIndexHigh, fileInfo.nFileIndexLow);
+    std::uint64_t size = (static_cast<std::uint64_t>(fileInfo.nFileSizeHigh) << 32) | fileInfo.nFileSizeLow;
+
+    bool changed = false;
+    if (fileID != state.fileID || size < state.readOffset) {
+      // Log has been replaced or truncated, so errors found so far belong to an earlier game session.
+      state.fileID = fileID;
+      state.readOffset = 0;
+      state.parser.reset();
+      state.errors.clear();
+      state.errorKeys.clear();
+      changed = true;
+    }
+    if (size == state.readOffset) {
+      return changed;
+    }
+
+    LARGE_INTEGER position { .QuadPart = static_cast<LONGLONG>(state.readOffset) };
+    if (!::SetFilePointerEx(file, position, nullptr, FILE_BEGIN)) {
+      return changed;
+    }
+
+    // Only what was there when file was opened is read, anything written after that is picked up next time.
+    std::vector<PapyrusLogParser::RuntimeError> runtimeErrors;
+    DWORD bytesRead = 0;
+    while (state.readOffset < size && ::ReadFile(file, buffer.data(), static_cast<DWORD>(std::min<std::uint64_t>(buffer.size(), size - state.readOffset)), &bytesRead, nullptr) && bytesRead > 0) {
+      state.parser.feed(std::string_view(buffer.data(), bytesRead), runtimeErrors);
+      state.readOffset += bytesRead;
+      for (const auto& runtimeError : runtimeErrors) {
+        addError(state, runtimeError, newErrors);
+      }
+      runtimeErrors.clear();
+
+      if (::WaitForSingleObject(stopEvent, 0) == WAIT_OBJECT_0) {
+        // Rest of a huge log is read after restart, from persisted offset.
+        return true;
+      }
+    }
+
+    state.parser.flush(runtimeErrors);
+    for (const auto& runtimeError : runtimeErrors) {
+      addError(state, runtimeError, newErrors);
+    }
+    return true;
+  }
+
+  void LogMonitor::addError(LogState& state, const PapyrusLogParser::RuntimeError& runtimeError, std::vector<Error>& newErrors) {
+    // Error is reported on the innermost frame with a script source line, as native functions don't have one.
+    auto frame = std::find_if(runtimeError.stack.begin(), runtimeError.stack.end(), [](const auto& frame) { return frame.line > 0; });
+    if (frame == runtimeError.stack.end() || state.errors.size() >= MAX_ERRORS_PER_LOG) {
+      return;
+    }
+    const std::wstring& filePath = findSource(state, frame->sourceFile);
+    if (filePath.empty()) {
+      return;
+    }
+
+    // Game logs in system code page.
+    std::wstring message = std::format(L"{} (runtime error in {}.{}())", string2wstring(runtimeError.message, CP_ACP), string2wstring(frame->script, CP_ACP), string2wstring(frame->function, CP_ACP));
+    if (state.errorKeys.insert(std::format(L"{}|{}|{}", utility::toUpper(filePath), frame->line, message)).second) {
+      Error error {
+        .file = filePath,
+        .message = std::move(message),
+        .line = frame->line
+      };
+      state.errors.push_back(error);
+      newErrors.push_back(std::move(error));
+    }
+  }
+
+  const std::wstring& LogMonitor::findSource(LogState& state, const std::string& sourceFile) {
+    auto [sourcePath, inserted] = state.sourcePaths.try_emplace(sourceFile);
+    if (inserted) {
+      std::filesystem::path relativePath(string2wstring(sourceFile, CP_ACP));
+      if (relativePath.is_absolute()) {
+        if (utility::fileExists(relativePath.wstring())) {
+          sourcePath->second = relativePath.wstring();
+        }
+      } else {
+        // Same as compiler, the first import directory that has the script wins.
+        for (const auto& importDirectory : state.log.importDirectories) {
+          std::wstring filePath = std::filesystem::path(importDirectory) / relativePath;
+          if (utility::fileExists(filePath)) {
+            sourcePath->second = filePath;
+            break;
+          }
+        }
+      }
+    }
+    return sourcePath->second;
+  }
+
+  bool LogMonitor::postErrors(std::vector<Error>&& errors, bool restored) const {
+    if (errors.empty()) {
+      return false;
+    }
+
+    // Message handler takes ownership of posted list.
+    auto postedErrors = std::make_unique<std::vector<Error>>(std::move(errors));
+    if (!::PostMessage(messageWindow, PPM_RUNTIME_ERRORS, reinterpret_cast<WPARAM>(postedErrors.get()), restored)) {
+      return false;
+    }
+    postedErrors.release();
+    return true;
+  }
+
+  void LogMonitor::load() {
+    loaded = true;
+    if (statePath.empty()) {
+      return;
+    }
+
+    std::wifstream stateFile(statePath);
+    stateFile.imbue(std::locale(stateFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+    std::wstring line;
+    LogState* state = nullptr;
+    while (std::getline(stateFile, line)) {
+      // Path or message goes last as message may contain the separator itself.
+      std::vector<std::wstring> fields;
+      size_t start = 0;
+      for (size_t end; fields.size() < 3 && (end = line.find(L'|', start)) != std::wstring::npos; start = end + 1) {
+        fields.push_back(line.substr(start, end - start));
+      }
+      if (fields.size() != 3) {
+        continue;
+      }
+
+      if (fields[0] == L"L") {
+        state = &states.emplace_back();
+        state->log.path = line.substr(start);
+        state->fileID = fields[1];
+        state->readOffset = strToUInt64(fields[2]);
+      } else if (fields[0] == L"E" && state) {
+        size_t separator = line.find(L'|', start);
+        if (separator != std::wstring::npos) {
+          Error error {
+            .file = line.substr(start, separator - start),
+            .message = line.substr(separator + 1),
+            .line = static_cast<int>(strToUInt64(fields[1])),
+            .column = static_cast<int>(strToUInt64(fields[2]))
+          };
+          state->errorKeys.insert(std::format(L"{}|{}|{}", utility::toUpper(error.file), error.line, error.message));
+          state->errors.push_back(std::move(error));
+        }
+      }
+    }
+  }
+
+  void LogMonitor::save() const {
+    if (!statePath.empty()) {
+      std::wofstream stateFile(statePath, std::wofstream::trunc);
+      auto autoCleanup = gsl::finally([&] { stateFile.close(); });
+      stateFile.imbue(std::locale(stateFile.getloc(), new std::codecvt_utf8<wchar_t>())); // Use UTF-8 encoding
+
+      // Each log is a line of: L|file ID|offset|log path, followed by one line per error found in it: E|line|column|file path|message.
+      // Unfinished last line is read again from its start next time.
+      for (const auto& state : states) {
+        stateFile << L"L|" << state.fileID << L'|' << (state.readOffset - state.parser.pendingSize()) << L'|' << state.log.path << std::endl;
+        for (const auto& error : state.errors) {
+          stateFile << L"E|" << error.line << L'|' << error.column << L'|' << error.file << L'|' << error.message << std::endl;
+        }
+      }
+    }
+  }
+
+} // namespace
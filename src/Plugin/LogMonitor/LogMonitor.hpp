@@ -0,0 +1,97 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "PapyrusLogParser.hpp"
+
+#include "..\CompilationErrorHandling\Error.hpp"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <windows.h>
+
+namespace papyrus {
+
+  // Watches games' Papyrus logs in a worker thread, and posts runtime errors found in newly written lines to message window
+  // with PPM_RUNTIME_ERRORS. Read offset of each log is persisted along with errors found so far, so nothing is read twice
+  // after Notepad++ restarts. A log is read from the start when the game replaces it, i.e. rotates logs on startup.
+  class LogMonitor {
+    public:
+      struct Log {
+        std::wstring path;
+        std::vector<std::wstring> importDirectories; // Where script sources named in stack frames are looked for
+
+        bool operator==(const Log&) const = default;
+      };
+
+      LogMonitor(HWND messageWindow, const std::wstring& statePath);
+      ~LogMonitor();
+
+      // Watch given logs, or stop watching if empty. Errors persisted for a log are posted again when it's first watched
+      void watch(const std::vector<Log>& logs);
+
+      // Drop errors found in given script files, e.g. once they are compiled again, so they are not posted again next session.
+      // The same errors are reported again if the game logs them after this
+      void forget(const std::vector<std::wstring>& files);
+
+    private:
+      struct LogState {
+        Log log;
+        bool watched {false};
+        bool posted {false}; // Whether errors loaded from state file have been posted
+        std::wstring fileID; // Volume serial number and file index, which change when log is replaced
+        std::uint64_t readOffset {0};
+        PapyrusLogParser parser;
+        std::vector<Error> errors; // Distinct errors found in current log
+        std::unordered_set<std::wstring> errorKeys;
+        std::unordered_map<std::string, std::wstring> sourcePaths; // Keyed by source file as logged, empty if not found
+      };
+
+      void start();
+      void run();
+      void stop();
+
+      // Read what has been written to log since last time, and append new distinct errors to the list. Returns true if state changed
+      bool read(LogState& state, std::vector<Error>& newErrors);
+      void addError(LogState& state, const PapyrusLogParser::RuntimeError& runtimeError, std::vector<Error>& newErrors);
+      const std::wstring& findSource(LogState& state, const std::string& sourceFile);
+      bool postErrors(std::vector<Error>&& errors, bool restored) const;
+
+      void load();
+      void save() const;
+
+      // Private members
+      //
+      HWND messageWindow;
+      std::wstring statePath;
+      bool loaded {false};
+      std::vector<LogState> states; // Only accessed by worker while it's running
+      std::vector<Log> watchedLogs;
+      std::vector<char> buffer;
+      HANDLE stopEvent;
+      std::thread monitorThread;
+  };
+
+} // namespace
@@ -0,0 +1,140 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PapyrusLogParser.hpp"
+
+#include <cstring>
+
+namespace papyrus {
+
+  namespace {
+    constexpr std::string_view ERROR_TAG = "] error: ";
+    constexpr std::string_view STACK_HEADER = "stack:";
+    constexpr std::string_view SOURCE_SEPARATOR = " - \"";
+    constexpr std::string_view LINE_SEPARATOR = "\" Line ";
+  }
+
+  void PapyrusLogParser::feed(std::string_view bytes, std::vector<RuntimeError>& errors) {
+    while (!bytes.empty()) {
+      const char* lineEnd = static_cast<const char*>(std::memchr(bytes.data(), '\n', bytes.size()));
+      if (!lineEnd) {
+        pendingLine.append(bytes);
+        return;
+      }
+
+      size_t length = static_cast<size_t>(lineEnd - bytes.data());
+      if (pendingLine.empty()) {
+        parseLine(bytes.substr(0, length), errors);
+      } else {
+        // Line was split between chunks.
+        pendingLine.append(bytes.substr(0, length));
+        parseLine(pendingLine, errors);
+        pendingLine.clear();
+      }
+      bytes.remove_prefix(length + 1);
+    }
+  }
+
+  void PapyrusLogParser::flush(std::vector<RuntimeError>& errors) {
+    if (inError && !currentError.stack.empty()) {
+      errors.push_back(std::move(currentError));
+      currentError = RuntimeError();
+      inError = false;
+      inStack = false;
+    }
+  }
+
+  void PapyrusLogParser::reset() {
+    pendingLine.clear();
+    currentError = RuntimeError();
+    inError = false;
+    inStack = false;
+  }
+
+  bool PapyrusLogParser::parseFrame(std::string_view line, Frame& frame) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+      return false;
+    }
+    line.remove_prefix(start);
+
+    size_t lineSeparator = line.rfind(LINE_SEPARATOR);
+    size_t sourceSeparator = (lineSeparator == std::string_view::npos) ? std::string_view::npos : line.rfind(SOURCE_SEPARATOR, lineSeparator);
+    if (sourceSeparator == std::string_view::npos) {
+      return false;
+    }
+
+    // Call is logged as object, script and function separated by dots. Object is enclosed in brackets and may contain dots itself,
+    // but script and function names never do.
+    std::string_view call = line.substr(0, sourceSeparator);
+    if (call.ends_with("()")) {
+      call.remove_suffix(2);
+    }
+    size_t functionDot = call.rfind('.');
+    if (functionDot == std::string_view::npos || functionDot == 0) {
+      return false;
+    }
+    size_t scriptDot = call.rfind('.', functionDot - 1);
+    size_t scriptStart = (scriptDot == std::string_view::npos) ? 0 : scriptDot + 1;
+
+    frame.script = call.substr(scriptStart, functionDot - scriptStart);
+    frame.function = call.substr(functionDot + 1);
+    frame.sourceFile = line.substr(sourceSeparator + SOURCE_SEPARATOR.size(), lineSeparator - sourceSeparator - SOURCE_SEPARATOR.size());
+    frame.line = 0;
+    for (char ch : line.substr(lineSeparator + LINE_SEPARATOR.size())) {
+      if (ch < '0' || ch > '9') {
+        break; // "?" when line is unknown, or line end
+      }
+      frame.line = frame.line * 10 + (ch - '0');
+    }
+    return true;
+  }
+
+  // Private methods
+  //
+
+  void PapyrusLogParser::parseLine(std::string_view line, std::vector<RuntimeError>& errors) {
+    if (line.ends_with('\r')) {
+      line.remove_suffix(1);
+    }
+
+    if (line.starts_with('[')) {
+      // Any other log entry ends stack of the error being parsed.
+      if (inError && !currentError.stack.empty()) {
+        errors.push_back(std::move(currentError));
+      }
+      currentError = RuntimeError();
+      inStack = false;
+
+      size_t tag = line.find(ERROR_TAG);
+      inError = (tag != std::string_view::npos);
+      if (inError) {
+        currentError.message = line.substr(tag + ERROR_TAG.size());
+      }
+    } else if (inError && !inStack) {
+      inStack = line.starts_with(STACK_HEADER);
+    } else if (inStack && (line.starts_with('\t') || line.starts_with(' '))) {
+      Frame frame;
+      if (parseFrame(line, frame)) {
+        currentError.stack.push_back(std::move(frame));
+      }
+    }
+  }
+
+} // namespace
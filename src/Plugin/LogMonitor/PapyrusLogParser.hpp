@@ -0,0 +1,75 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace papyrus {
+
+  // Streaming parser of game's Papyrus log. Bytes are fed in chunks of any size as they are read, and only the unfinished
+  // last line is kept between chunks, so memory use doesn't grow with log size. A runtime error is logged as a header line
+  // followed by its stack, innermost frame first:
+  //
+  //   [10/17/2026 - 06:12:34PM] error: Cannot call GetValue() on a None object, aborting function call
+  //   stack:
+  //   	[MyQuest (0A000D62)].MyScript.OnUpdate() - "MyScript.psc" Line 42
+  //
+  class PapyrusLogParser {
+    public:
+      struct Frame {
+        std::string script;
+        std::string function;
+        std::string sourceFile; // As logged, i.e. file name, or relative path following namespace in Fallout 4
+        int line {0}; // 0 if unknown, e.g. native functions
+      };
+
+      struct RuntimeError {
+        std::string message;
+        std::vector<Frame> stack;
+      };
+
+      // Parse a chunk of bytes, and append errors whose stack is complete to the list
+      void feed(std::string_view bytes, std::vector<RuntimeError>& errors);
+
+      // Complete error being parsed if its stack has been seen, as end of log has been reached
+      void flush(std::vector<RuntimeError>& errors);
+
+      void reset();
+
+      // Size of unfinished last line. Parsing can resume from where it starts without losing anything but the error being parsed
+      inline size_t pendingSize() const noexcept { return pendingLine.size(); }
+
+      // Parse a stack frame line, e.g. "[Object].Script.Function() - "Script.psc" Line 42"
+      static bool parseFrame(std::string_view line, Frame& frame);
+
+    private:
+      void parseLine(std::string_view line, std::vector<RuntimeError>& errors);
+
+      // Private members
+      //
+      std::string pendingLine;
+      RuntimeError currentError;
+      bool inError {false};
+      bool inStack {false};
+  };
+
+} // namespace
@@ -36,6 +36,9 @@ https://www.creationkit.com/fallout4/index.php?title=Category:Papyrus
 #include "Common\StringUtil.hpp"
 #include "Common\Version.hpp"
 #include "Compiler\CompilationRequest.hpp"
+#include "Compiler\DependencyGraph.hpp"
+#include "Compiler\PexAnonymizer.hpp"
+#include "Compiler\PexReader.hpp"
 #include "Lexer\Lexer.hpp"
 #include "Lexer\LexerData.hpp"
 
@@ -44,7 +47,9 @@ https://www.creationkit.com/fallout4/index.php?title=Category:Papyrus
 #include "..\external\tinyxml2\tinyxml2.h"
 #include "..\external\XMessageBox\XMessageBox.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -59,11 +64,19 @@ namespace papyrus {
 
   // Internal static variables
   namespace {
+    constexpr int COMPILE_ON_SAVE_DELAY = 500; // Milliseconds to wait for more files being saved before compiling them
+    constexpr int SYNTAX_CHECK_DELAY = 1000; // Milliseconds to wait for user to stop typing before checking syntax in background
+    constexpr size_t PROJECT_BUILD_REPORTED_JOBS = 3; // Number of slowest jobs shown in status bar after a project build
+
     std::vector<LPCWSTR> advancedMenuItems {
       L"Reset Lexer styles to current UI theme default...",
       L"Show langID...",
       L"Install auto completion support...",
-      L"Install function list support..."
+      L"Install function list support...",
+      L"Anonymize all PEX files in output directory...",
+      L"Verify all PEX files in output directory...",
+      L"Show compiled output cache statistics...",
+      L"Show compilation timing report..."
     };
     std::wstring configPath;
   }
@@ -71,6 +84,9 @@ namespace papyrus {
   Plugin::Plugin()
     : funcs{
       FuncItem{ L"Compile", compileMenuFunc, 0, false, new ShortcutKey{true, false, true, 0x43} },
+      FuncItem{ L"Incremental build", incrementalBuildMenuFunc, 0, false, new ShortcutKey{true, true, true, 0x43} },
+      FuncItem{ L"Cancel compilation", cancelCompilationMenuFunc, 0, false, nullptr },
+      FuncItem{ L"Inspect PEX", inspectPexMenuFunc, 0, false, nullptr },
       FuncItem{ L"Go to matched keyword", goToMatchMenuFunc, 0, false, new ShortcutKey{true, true, false, 0xDC} },
       FuncItem{ L"Settings...", settingsMenuFunc, 0, false, nullptr },
       FuncItem{}, // Separator1
@@ -130,6 +146,9 @@ namespace papyrus {
           if (notification->updated & SC_UPDATE_SELECTION) {
             handleSelectionChange(notification);
           }
+          if ((notification->updated & (SC_UPDATE_V_SCROLL | SC_UPDATE_H_SCROLL)) && errorAnnotator) {
+            errorAnnotator->handleScroll(static_cast<HWND>(notification->nmhdr.hwndFrom));
+          }
           break;
         }
       }
@@ -150,6 +169,12 @@ namespace papyrus {
           break;
         }
 
+        case NPPN_SHUTDOWN: {
+          // Stop log monitor's worker while it can still be joined, before plugin is unloaded.
+          logMonitor.reset();
+          break;
+        }
+
         case NPPN_EXTERNALLEXERBUFFER: {
           Lexer::assignBufferID(notification->nmhdr.idFrom);
           break;
@@ -162,6 +187,21 @@ namespace papyrus {
           break;
         }
 
+        case NPPN_FILESAVED: {
+          if (!isSavingForCompilation && settings.compilerSettings.compileOnSave) {
+            npp_buffer_t bufferID = notification->nmhdr.idFrom;
+            if (std::find(savedBuffers.begin(), savedBuffers.end(), bufferID) == savedBuffers.end()) {
+              savedBuffers.push_back(bufferID);
+            }
+
+            // Wait for a short while so saving multiple files at once results in one batch.
+            compileOnSaveTimer = utility::startTimer(COMPILE_ON_SAVE_DELAY, [&] {
+              ::PostMessage(messageWindow, PPM_COMPILE_SAVED_FILES, 0, 0);
+            }, true);
+          }
+          break;
+        }
+
         case NPPN_LANGCHANGED: {
           handleBufferActivation(notification->nmhdr.idFrom, true);
           break;
@@ -197,6 +237,22 @@ namespace papyrus {
             case AdvancedMenu::InstallFunctionList:
               installFunctionList();
               break;
+
+            case AdvancedMenu::AnonymizeOutputDirectory:
+              anonymizeOutputDirectory();
+              break;
+
+            case AdvancedMenu::VerifyOutputDirectory:
+              verifyOutputDirectory();
+              break;
+
+            case AdvancedMenu::ShowOutputCacheStatistics:
+              showOutputCacheStatistics();
+              break;
+
+            case AdvancedMenu::ShowCompilationTimingReport:
+              showCompilationTimingReport();
+              break;
           }
         }
         break;
@@ -211,6 +267,7 @@ namespace papyrus {
   void Plugin::initializeComponents() {
     lexerData = std::make_unique<LexerData>(nppData, settings.lexerSettings);
     errorsWindow = std::make_unique<ErrorsWindow>(myInstance, nppData._nppHandle, messageWindow);
+    pexInspectorWindow = std::make_unique<PexInspectorWindow>(myInstance, nppData._nppHandle);
     errorAnnotator = std::make_unique<ErrorAnnotator>(nppData, settings.errorAnnotatorSettings);
     keywordMatcher = std::make_unique<KeywordMatcher>(nppData, settings.keywordMatcherSettings);
     settingsDialog.init(myInstance, nppData._nppHandle);
@@ -235,7 +292,11 @@ namespace papyrus {
       onSettingsUpdated();
 
       // Only initialize compiler when settings are ready.
-      compiler = std::make_unique<Compiler>(messageWindow, settings.compilerSettings);
+      compiler = std::make_unique<Compiler>(messageWindow, settings.compilerSettings, configPath);
+      syntaxChecker = std::make_unique<Compiler>(messageWindow, settings.compilerSettings);
+      errorStore.init(std::filesystem::path(configPath) / PLUGIN_NAME L".errors");
+      logMonitor = std::make_unique<LogMonitor>(messageWindow, std::filesystem::path(configPath) / PLUGIN_NAME L".runtime");
+      updateLogMonitor();
     }
   }
 
@@ -332,7 +393,7 @@ namespace papyrus {
       if (activeCompilationRequest.bufferID != 0) {
         isCompilingCurrentFile = utility::compare(activeCompilationRequest.filePath, filePath);
         if (isCompilingCurrentFile && !fromLangChange) {
-          ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Compiling..."));
+          ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(getCompilingStatus().c_str()));
         }
       }
 
@@ -391,7 +452,15 @@ namespace papyrus {
 
       // Only Papyrus script and assembly files can be annotated.
       if ((isPapyrusScriptFile || utility::endsWith(filePath, L".pas")) && !fromLangChange && errorAnnotator) {
-        errorAnnotator->annotate(currentView, filePath);
+        // Errors reported before, e.g. prior to a restart, still apply if file has not changed since. Unsaved changes
+        // would move lines around, and an active compilation is about to report errors anyway.
+        std::vector<Error> storedErrors;
+        if (activeCompilationRequest.bufferID == 0 && !errorAnnotator->hasErrors(filePath) && !::SendMessage(scintillaHandle, SCI_GETMODIFY, 0, 0)
+          && errorStore.find(filePath, storedErrors)) {
+          errorAnnotator->update(filePath, storedErrors);
+        } else {
+          errorAnnotator->annotate(currentView, filePath);
+        }
       }
 
       if (lexerData) {
@@ -436,17 +505,42 @@ namespace papyrus {
   }
 
   void Plugin::handleContentChange(SCNotification* notification) {
+    HWND scintillaHandle = static_cast<HWND>(notification->nmhdr.hwndFrom);
+    npp_buffer_t bufferID = getBufferFromScintillaHandle(scintillaHandle);
+
     // Since lexer checks for buffer ID, there is not need to ensure current buffer is a Papyrus Script buffer.
     if (lexerData) {
-      HWND scintillaHandle = static_cast<HWND>(notification->nmhdr.hwndFrom);
       ChangeEventData changeEventData {
         .scintillaHandle = scintillaHandle,
-        .bufferID = getBufferFromScintillaHandle(scintillaHandle),
+        .bufferID = bufferID,
         .position = notification->position,
         .linesAdded = notification->linesAdded
       };
       lexerData->changeEventData = changeEventData;
     }
+
+    // Both views are notified when they show the same document, so line changes are only handled for one of them.
+    bool isClonedView = (scintillaHandle == nppData._scintillaSecondHandle && getBufferFromScintillaHandle(nppData._scintillaMainHandle) == bufferID);
+    int line = 0;
+    if (notification->linesAdded != 0) {
+      line = static_cast<int>(::SendMessage(scintillaHandle, SCI_LINEFROMPOSITION, notification->position, 0));
+
+      if (errorAnnotator && !isClonedView) {
+        errorAnnotator->handleContentChange(scintillaHandle, line, static_cast<int>(notification->linesAdded));
+      }
+    }
+
+    if (syntaxChecker && settings.compilerSettings.checkSyntaxInBackground && isCurrentBufferManaged(scintillaHandle)) {
+      // Lines added/deleted after snapshot was taken are needed to map check result to current content.
+      if (bufferID == activeSyntaxCheckRequest.bufferID && notification->linesAdded != 0 && !isClonedView) {
+        syntaxCheckEdits.emplace_back(line, static_cast<int>(notification->linesAdded));
+      }
+
+      // Wait for user to stop typing before checking.
+      syntaxCheckTimer = utility::startTimer(SYNTAX_CHECK_DELAY, [this, bufferID, scintillaHandle] {
+        ::PostMessage(messageWindow, PPM_CHECK_SYNTAX, static_cast<WPARAM>(bufferID), reinterpret_cast<LPARAM>(scintillaHandle));
+      }, true);
+    }
   }
 
   void Plugin::handleSelectionChange(SCNotification* notification) {
@@ -466,6 +560,7 @@ namespace papyrus {
       updateLexerDataGameSettings(Game::SkyrimSE, settings.compilerSettings.sse);
       updateLexerDataGameSettings(Game::Fallout4, settings.compilerSettings.fo4);
     }
+    updateLogMonitor();
   }
 
   void Plugin::updateLexerDataGameSettings(Game game, const CompilerSettings::GameSettings& gameSettings) {
@@ -479,6 +574,24 @@ namespace papyrus {
     }
   }
 
+  void Plugin::updateLogMonitor() {
+    if (logMonitor) {
+      std::vector<LogMonitor::Log> logs;
+      if (settings.compilerSettings.monitorRuntimeLog) {
+        for (Game game : { Game::Skyrim, Game::SkyrimSE, Game::Fallout4 }) {
+          const auto& gameSettings = settings.compilerSettings.gameSettings(game);
+          std::wstring logPath = game::logPath(game);
+          if (gameSettings.enabled && !logPath.empty()) {
+            std::vector<std::wstring> importDirectories = utility::split(gameSettings.importDirectories, L";");
+            std::erase_if(importDirectories, [](const auto& importDirectory) { return importDirectory.empty(); });
+            logs.push_back({ .path = logPath, .importDirectories = importDirectories });
+          }
+        }
+      }
+      logMonitor->watch(logs);
+    }
+  }
+
   void Plugin::detectLangID() {
     if (scriptLangID == 0) {
       std::wstring lexerName = string2wstring(LEXER_NAME, SC_CP_UTF8);
@@ -565,12 +678,113 @@ namespace papyrus {
     return std::make_pair(detectedGameType, useAutoModeOutputDirectory);
   }
 
+  std::filesystem::path Plugin::getOutputDirectory(const std::wstring& filePath) const {
+    auto [detectedGame, useAutoModeOutputDirectory] = detectGameType(filePath, settings.compilerSettings);
+    if (detectedGame == Game::Auto) {
+      ::MessageBox(nppData._nppHandle, L"No game is configured. Please at least enable one game in Settings dialog!", PLUGIN_NAME L" plugin", MB_ICONWARNING | MB_OK);
+      return std::filesystem::path();
+    }
+
+    if (useAutoModeOutputDirectory) {
+      return std::filesystem::path(filePath).parent_path() / settings.compilerSettings.autoModeOutputDirectory; // Absolute path simply replaces the file's directory
+    }
+    return settings.compilerSettings.gameSettings(detectedGame).outputDirectory;
+  }
+
   void Plugin::clearActiveCompilation() {
     activeCompilationRequest = {
       .game = Game::Auto,
       .bufferID = 0
     };
     isCompilingCurrentFile = false;
+
+    if (!queuedCompilationRequests.empty()) {
+      // Result message of active compilation is still being handled at this point, and compiler's worker thread
+      // may be waiting for it to return, so defer starting next one.
+      ::PostMessage(messageWindow, PPM_START_QUEUED_COMPILATION, 0, 0);
+    }
+  }
+
+  void Plugin::startCompilation(const CompilationRequest& request) {
+    if (errorsWindow) {
+      clearErrorsWindow();
+      errorsWindow->hide();
+    }
+
+    activeCompilationRequest = request;
+    isCompilingCurrentFile = (request.bufferID == ::SendMessage(nppData._nppHandle, NPPM_GETCURRENTBUFFERID, 0, 0));
+    ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(getCompilingStatus().c_str()));
+
+    compiler->start(activeCompilationRequest);
+  }
+
+  std::vector<std::wstring> Plugin::getCompilationScopes() {
+    std::vector<std::wstring> scopes = compiler->getCompiledFiles();
+    for (const auto& compiledFile : compiler->getCompiledFiles()) {
+      auto iter = reportedFiles.find(utility::toUpper(compiledFile));
+      if (iter != reportedFiles.end()) {
+        scopes.insert(scopes.end(), iter->second.begin(), iter->second.end());
+        reportedFiles.erase(iter);
+      }
+    }
+    return scopes;
+  }
+
+  void Plugin::recordReportedFiles(const std::vector<Error>& errors) {
+    std::set<std::wstring> compiledKeys;
+    for (const auto& compiledFile : compiler->getCompiledFiles()) {
+      compiledKeys.insert(utility::toUpper(compiledFile));
+    }
+
+    // A batch reports errors of all its scripts together, so each compiled script is linked to all other files.
+    std::set<std::wstring> otherFiles;
+    for (const auto& error : errors) {
+      if (!compiledKeys.contains(utility::toUpper(error.file))) {
+        otherFiles.insert(error.file);
+      }
+    }
+    if (!otherFiles.empty()) {
+      for (const auto& compiledKey : compiledKeys) {
+        reportedFiles[compiledKey].insert(otherFiles.begin(), otherFiles.end());
+      }
+    }
+  }
+
+  void Plugin::clearCompiledErrors() {
+    auto scopes = getCompilationScopes();
+    if (errorAnnotator) {
+      errorAnnotator->annotate(scopes, {});
+    }
+    errorStore.update(scopes, {});
+    forgetRuntimeErrors(scopes);
+  }
+
+  void Plugin::forgetRuntimeErrors(const std::vector<std::wstring>& scopes) {
+    size_t forgottenCount = std::erase_if(runtimeErrors, [&](const Error& error) {
+      return std::any_of(scopes.begin(), scopes.end(), [&](const auto& scope) { return utility::compare(error.file, scope); });
+    });
+    if (forgottenCount > 0 && logMonitor) {
+      logMonitor->forget(scopes);
+    }
+  }
+
+  void Plugin::clearErrorsWindow() {
+    errorsWindow->clear();
+    errorsWindow->append(runtimeErrors);
+  }
+
+  std::wstring Plugin::getCompilingStatus() const {
+    std::wstring status(L"Compiling");
+    if (!activeCompilationRequest.batchedFiles.empty()) {
+      status += L" " + std::to_wstring(activeCompilationRequest.batchedFiles.size() + 1) + L" scripts";
+    } else if (!isCompilingCurrentFile) {
+      status += L": " + activeCompilationRequest.filePath;
+    }
+    status += L"...";
+    if (!queuedCompilationRequests.empty()) {
+      status += L" (" + std::to_wstring(queuedCompilationRequests.size()) + L" queued)";
+    }
+    return status;
   }
 
   LRESULT CALLBACK Plugin::messageHandleProc(HWND window, UINT message, WPARAM wParam, LPARAM lParam) {
@@ -580,35 +794,93 @@ namespace papyrus {
   LRESULT Plugin::handleOwnMessage(HWND window, UINT message, WPARAM wParam, LPARAM lParam) {
     switch (message) {
       case PPM_COMPILATION_DONE: {
+        std::wstring msg;
+        if (wParam & PARAM_INCREMENTAL_BUILD) {
+          msg = (lParam == 0 ? L"Incremental build succeeded, all scripts are up to date" : L"Incremental build succeeded, " + std::to_wstring(lParam) + L" script(s) compiled");
+          if (wParam & PARAM_COMPILATION_WITH_ANONYMIZATION) {
+            msg += L" and anonymized";
+          }
+        } else if (lParam == 0) {
+          msg = L"Compilation skipped, only comments or whitespace changed";
+        } else {
+          msg = L"Compilation ";
+          if (wParam & PARAM_COMPILATION_WITH_ANONYMIZATION) {
+            msg += L"and anonymization ";
+          }
+          msg += L"succeeded";
+          if (lParam > 1) {
+            msg += L": " + std::to_wstring(lParam) + L" scripts";
+          }
+          size_t skippedCount = (wParam >> PARAM_SKIPPED_SHIFT) & PARAM_SKIPPED_MASK;
+          if (skippedCount > 0) {
+            msg += L" (" + std::to_wstring(skippedCount) + L" skipped, only comments or whitespace changed)";
+          }
+        }
+        size_t restoredCount = (wParam >> PARAM_RESTORED_FROM_CACHE_SHIFT) & PARAM_RESTORED_FROM_CACHE_MASK;
+        if (restoredCount > 0) {
+          msg += L" (" + std::to_wstring(restoredCount) + L" restored from cache)";
+        }
+        if (wParam & PARAM_DEPLOYED) {
+          msg += L", changed outputs deployed";
+        }
+        if (!isCompilingCurrentFile && activeCompilationRequest.batchedFiles.empty()) {
+          msg += L": " + activeCompilationRequest.filePath;
+        }
+        ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(msg.c_str()));
+        clearCompiledErrors();
         if (errorsWindow) {
-          errorsWindow->clear();
+          clearErrorsWindow();
           errorsWindow->hide();
         }
+        clearActiveCompilation();
+        return 0;
+      }
+
+      case PPM_PROJECT_BUILD_DONE: {
+        // Report total time, and the slowest jobs as they determine how long project build takes.
+        auto* summary = reinterpret_cast<Compiler::ProjectBuildSummary*>(wParam);
+        std::vector<const CompilationRecord*> jobs;
+        for (const auto& job : summary->jobs) {
+          jobs.push_back(&job);
+        }
+        std::sort(jobs.begin(), jobs.end(), [](const auto* job1, const auto* job2) { return job1->total() > job2->total(); });
 
-        std::wstring msg(L"Compilation ");
-        if (wParam == PARAM_COMPILATION_WITH_ANONYMIZATION) {
-          msg += L"and anonymization ";
+        std::wstring msg = std::format(L"Project build succeeded: {} script(s) compiled{} in {:.1f}s", jobs.size(), summary->anonymized ? L" and anonymized" : L"", summary->elapsed.count() / 1000000.0);
+        if (summary->deployedCount > 0) {
+          msg += std::format(L", {} file(s) deployed", summary->deployedCount);
+        }
+        for (size_t i = 0; i < jobs.size() && i < PROJECT_BUILD_REPORTED_JOBS; ++i) {
+          msg += std::format(L"{} {} {:.1f}s", i == 0 ? L", slowest:" : L",", std::filesystem::path(jobs[i]->filePath).filename().wstring(), jobs[i]->total().count() / 1000000.0);
         }
-        msg += L"succeeded";
         if (!isCompilingCurrentFile) {
           msg += L": " + activeCompilationRequest.filePath;
         }
         ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(msg.c_str()));
+        clearCompiledErrors();
+        if (errorsWindow) {
+          clearErrorsWindow();
+          errorsWindow->hide();
+        }
         clearActiveCompilation();
         return 0;
       }
 
       case PPM_COMPILATION_FAILED: {
+        if (wParam) {
+          auto scopes = getCompilationScopes();
+          const auto& errors = *reinterpret_cast<std::vector<Error>*>(wParam);
+          if (errorAnnotator) {
+            errorAnnotator->annotate(scopes, errors);
+          }
+          errorStore.update(scopes, errors);
+          recordReportedFiles(errors);
+          forgetRuntimeErrors(scopes);
+        }
         if (errorsWindow) {
-          errorsWindow->clear();
+          clearErrorsWindow();
           if (wParam) {
-            std::vector<Error>* errors = reinterpret_cast<std::vector<Error>*>(wParam);
-
-            errorsWindow->show(*errors);
-
-            if (errorAnnotator) {
-              errorAnnotator->annotate(*errors);
-            }
+            errorsWindow->append(*reinterpret_cast<std::vector<Error>*>(wParam));
+            errorsWindow->display();
           }
         }
 
@@ -632,8 +904,9 @@ namespace papyrus {
       }
 
       case PPM_ANONYMIZATION_FAILED: {
+        clearCompiledErrors();
         if (errorsWindow) {
-          errorsWindow->clear();
+          clearErrorsWindow();
         }
 
         std::wstring msg(L"Compilation succeeded but anonymization failed: ");
@@ -646,12 +919,148 @@ namespace papyrus {
         return 0;
       }
 
+      case PPM_DEPLOYMENT_FAILED: {
+        clearCompiledErrors();
+        if (errorsWindow) {
+          clearErrorsWindow();
+        }
+
+        std::wstring msg(L"Compilation succeeded but deployment failed: ");
+        msg += *reinterpret_cast<std::wstring*>(wParam);
+        if (!isCompilingCurrentFile) {
+          msg += L" File: " + activeCompilationRequest.filePath;
+        }
+        ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(msg.c_str()));
+        clearActiveCompilation();
+        return 0;
+      }
+
       case PPM_OTHER_ERROR: {
         clearActiveCompilation();
         ::MessageBox(nppData._nppHandle, reinterpret_cast<wchar_t*>(wParam), reinterpret_cast<wchar_t*>(lParam), MB_ICONERROR | MB_OK);
         return 0;
       }
 
+      case PPM_COMPILATION_CANCELLED: {
+        std::wstring msg(L"Compilation cancelled");
+        if (!isCompilingCurrentFile) {
+          msg += L": " + activeCompilationRequest.filePath;
+        }
+        ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(msg.c_str()));
+        clearActiveCompilation();
+        return 0;
+      }
+
+      case PPM_COMPILATION_TIMED_OUT: {
+        std::wstring msg(L"Compilation timed out after " + std::to_wstring(wParam) + L" second(s)");
+        if (!isCompilingCurrentFile) {
+          msg += L": " + activeCompilationRequest.filePath;
+        }
+        ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(msg.c_str()));
+        clearActiveCompilation();
+        return 0;
+      }
+
+      case PPM_CHECK_SYNTAX: {
+        checkSyntax(static_cast<npp_buffer_t>(wParam), reinterpret_cast<HWND>(lParam));
+        return 0;
+      }
+
+      case PPM_RUNTIME_ERRORS: {
+        std::unique_ptr<std::vector<Error>> errors(reinterpret_cast<std::vector<Error>*>(wParam));
+        if (!settings.compilerSettings.monitorRuntimeLog) {
+          return 0;
+        }
+
+        // Errors found in last session are listed without bringing up the window.
+        runtimeErrors.insert(runtimeErrors.end(), errors->begin(), errors->end());
+        if (errorsWindow) {
+          errorsWindow->append(*errors);
+          if (!lParam) {
+            errorsWindow->display();
+          }
+        }
+        if (errorAnnotator) {
+          errorAnnotator->add(*errors);
+        }
+        return 0;
+      }
+
+      case PPM_SYNTAX_CHECK_DONE: {
+        Compiler::SyntaxCheckResult& result = *reinterpret_cast<Compiler::SyntaxCheckResult*>(wParam);
+
+        // Result of an outdated snapshot is discarded. So is one arriving during a compilation, which is about to annotate the same file.
+        if (result.completed && pendingSyntaxCheck.first == 0 && activeCompilationRequest.bufferID == 0 && errorAnnotator && settings.compilerSettings.checkSyntaxInBackground) {
+          std::vector<Error> errors;
+          for (auto& error : result.errors) {
+            // Map line of the snapshot to current content. Errors on deleted lines are dropped.
+            int line = error.line - 1;
+            bool isDeleted = false;
+            for (auto [editLine, linesAdded] : syntaxCheckEdits) {
+              if (linesAdded < 0 && line > editLine && line <= editLine - linesAdded) {
+                isDeleted = true;
+                break;
+              }
+              if (line > editLine) {
+                line += linesAdded;
+              }
+            }
+
+            if (!isDeleted) {
+              error.line = line + 1;
+              errors.push_back(std::move(error));
+            }
+          }
+          errorAnnotator->update(result.filePath, errors);
+        }
+
+        activeSyntaxCheckRequest = {
+          .game = Game::Auto,
+          .bufferID = 0
+        };
+        syntaxCheckEdits.clear();
+
+        if (pendingSyntaxCheck.first != 0) {
+          // Syntax checker's worker thread is waiting for this message to return, so defer starting next one.
+          ::PostMessage(messageWindow, PPM_CHECK_SYNTAX, static_cast<WPARAM>(pendingSyntaxCheck.first), reinterpret_cast<LPARAM>(pendingSyntaxCheck.second));
+          pendingSyntaxCheck = std::make_pair(0, nullptr);
+        }
+        return 0;
+      }
+
+      case PPM_COMPILE_SAVED_FILES: {
+        compileSavedFiles();
+        return 0;
+      }
+
+      case PPM_START_QUEUED_COMPILATION: {
+        if (activeCompilationRequest.bufferID == 0 && !queuedCompilationRequests.empty()) {
+          CompilationRequest request = queuedCompilationRequests.front();
+          queuedCompilationRequests.pop_front();
+
+          // Compile other queued scripts in the same directory along with this one, so compiler only needs to be started once.
+          if (!request.incremental && !request.project) {
+            std::wstring directory = std::filesystem::path(request.filePath).parent_path();
+            std::erase_if(queuedCompilationRequests,
+              [&](const auto& queuedRequest) {
+                if (queuedRequest.incremental || queuedRequest.project || queuedRequest.game != request.game || queuedRequest.useAutoModeOutputDirectory != request.useAutoModeOutputDirectory
+                  || !utility::compare(std::filesystem::path(queuedRequest.filePath).parent_path().wstring(), directory)) {
+                  return false;
+                }
+                request.batchedFiles.push_back(ScriptFile {
+                  .bufferID = queuedRequest.bufferID,
+                  .filePath = queuedRequest.filePath
+                });
+                request.batchedFiles.insert(request.batchedFiles.end(), queuedRequest.batchedFiles.begin(), queuedRequest.batchedFiles.end());
+                return true;
+              }
+            );
+          }
+          startCompilation(request);
+        }
+        return 0;
+      }
+
       case PPM_JUMP_TO_ERROR: {
         Error* error = reinterpret_cast<Error*>(wParam);
         if (!error->file.empty()) {
@@ -846,70 +1255,303 @@ namespace papyrus {
     }
   }
 
+  void Plugin::anonymizeOutputDirectory() {
+    // Use output directory of the game detected for current file.
+    wchar_t filePath[MAX_PATH];
+    if (!::SendMessage(nppData._nppHandle, NPPM_GETFULLCURRENTPATH, MAX_PATH, reinterpret_cast<LPARAM>(filePath))) {
+      return;
+    }
+    std::filesystem::path outputDirectory = getOutputDirectory(filePath);
+    if (outputDirectory.empty()) {
+      return;
+    }
+
+    std::wstring msg(L"All PEX files in " + outputDirectory.wstring() + L" and its subdirectories will be anonymized. Continue?");
+    if (::MessageBox(nppData._nppHandle, msg.c_str(), PLUGIN_NAME L" plugin", MB_ICONQUESTION | MB_YESNO) == IDYES) {
+      size_t fileCount {0};
+      std::wstring errorMsg;
+      if (PexAnonymizer::anonymizeDirectory(outputDirectory, fileCount, errorMsg)) {
+        msg = std::to_wstring(fileCount) + L" PEX file(s) anonymized.";
+        ::MessageBox(nppData._nppHandle, msg.c_str(), PLUGIN_NAME L" plugin", MB_ICONINFORMATION | MB_OK);
+      } else {
+        ::MessageBox(nppData._nppHandle, errorMsg.c_str(), PLUGIN_NAME L" plugin", MB_ICONERROR | MB_OK);
+      }
+    }
+  }
+
+  void Plugin::verifyOutputDirectory() {
+    // Use output directory of the game detected for current file.
+    wchar_t filePath[MAX_PATH];
+    if (!::SendMessage(nppData._nppHandle, NPPM_GETFULLCURRENTPATH, MAX_PATH, reinterpret_cast<LPARAM>(filePath))) {
+      return;
+    }
+    std::filesystem::path outputDirectory = getOutputDirectory(filePath);
+    if (outputDirectory.empty()) {
+      return;
+    }
+
+    size_t fileCount {0};
+    auto invalidFiles = PexReader::verifyDirectory(outputDirectory, fileCount);
+    if (invalidFiles.empty()) {
+      std::wstring msg(L"All " + std::to_wstring(fileCount) + L" PEX file(s) in " + outputDirectory.wstring() + L" are valid.");
+      ::MessageBox(nppData._nppHandle, msg.c_str(), PLUGIN_NAME L" plugin", MB_ICONINFORMATION | MB_OK);
+    } else {
+      constexpr size_t MAX_LISTED_FILES = 20;
+      std::wstring msg(std::to_wstring(invalidFiles.size()) + L" of " + std::to_wstring(fileCount) + L" PEX file(s) are invalid:\r\n");
+      for (size_t i = 0; i < invalidFiles.size() && i < MAX_LISTED_FILES; ++i) {
+        msg += L"\r\n" + invalidFiles[i].first + L"\r\n    " + invalidFiles[i].second;
+      }
+      if (invalidFiles.size() > MAX_LISTED_FILES) {
+        msg += L"\r\n...";
+      }
+      ::MessageBox(nppData._nppHandle, msg.c_str(), PLUGIN_NAME L" plugin", MB_ICONWARNING | MB_OK);
+    }
+  }
+
+  void Plugin::showOutputCacheStatistics() {
+    if (!compiler) {
+      ::MessageBox(nppData._nppHandle, L"Compiler is not configured yet. Please complete Papyrus settings first!", PLUGIN_NAME L" plugin", MB_ICONWARNING | MB_OK);
+      return;
+    }
+
+    OutputCache& outputCache = compiler->getOutputCache();
+    auto statistics = outputCache.getStatistics();
+    std::uint64_t lookups = statistics.hits + statistics.misses;
+    std::wstring msg(L"Cached outputs: " + std::to_wstring(statistics.entryCount)
+      + L"\r\nSize: " + std::to_wstring(statistics.totalSize / 1024) + L" KiB of " + std::to_wstring(settings.compilerSettings.outputCacheSize) + L" MiB"
+      + L"\r\nHits: " + std::to_wstring(statistics.hits) + L", misses: " + std::to_wstring(statistics.misses)
+      + L"\r\nHit rate: " + (lookups > 0 ? std::to_wstring(statistics.hits * 100 / lookups) + L"%" : L"N/A")
+      + L"\r\nEvictions: " + std::to_wstring(statistics.evictions)
+      + L"\r\n\r\nClear the cache?");
+    if (::MessageBox(nppData._nppHandle, msg.c_str(), PLUGIN_NAME L" plugin", MB_ICONINFORMATION | MB_YESNO | MB_DEFBUTTON2) == IDYES) {
+      outputCache.clear();
+      outputCache.save();
+    }
+  }
+
+  void Plugin::showCompilationTimingReport() {
+    if (!compiler) {
+      ::MessageBox(nppData._nppHandle, L"Compiler is not configured yet. Please complete Papyrus settings first!", PLUGIN_NAME L" plugin", MB_ICONWARNING | MB_OK);
+      return;
+    }
+
+    ::MessageBox(nppData._nppHandle, compiler->getCompilationHistory().report().c_str(), PLUGIN_NAME L" plugin", MB_ICONINFORMATION | MB_OK);
+  }
+
   void Plugin::compileMenuFunc() {
     papyrusPlugin.compile();
   }
 
-  void Plugin::compile() {
-    if (compiler) {
-      if (activeCompilationRequest.bufferID == 0) {
-        // Get current file path.
-        wchar_t filePath[MAX_PATH];
-        if (::SendMessage(nppData._nppHandle, NPPM_GETFULLCURRENTPATH, MAX_PATH, reinterpret_cast<LPARAM>(filePath))) {
-          // Check if current file is handled by Papyrus Script lexer.
-          detectLangID();
-          npp_lang_type_t currentFileLangID;
-          ::SendMessage(nppData._nppHandle, NPPM_GETCURRENTLANGTYPE, 0, reinterpret_cast<LPARAM>(&currentFileLangID));
-
-          // Check file extension to make sure it is ".psc", and is lexed by this plugin's lexer or compiling unmanaged files is allowed.
-          std::wstring currentFile(filePath);
-          if (utility::endsWith(currentFile, L".psc") && (currentFileLangID == scriptLangID || settings.compilerSettings.allowUnmanagedSource)) {
-            auto [detectedGame, useAutoModeOutputDirectory] = detectGameType(filePath, settings.compilerSettings);
-            if (detectedGame != Game::Auto) {
-              if (errorsWindow) {
-                errorsWindow->clear();
-                errorsWindow->hide();
-              }
+  void Plugin::incrementalBuildMenuFunc() {
+    papyrusPlugin.compile(true);
+  }
 
-              if (errorAnnotator) {
-                errorAnnotator->clear();
-              }
+  void Plugin::cancelCompilationMenuFunc() {
+    papyrusPlugin.cancelCompilation();
+  }
 
-              activeCompilationRequest = {
-                .game = detectedGame,
-                .bufferID = ::SendMessage(nppData._nppHandle, NPPM_GETCURRENTBUFFERID, 0, 0),
-                .filePath { currentFile },
-                .useAutoModeOutputDirectory = useAutoModeOutputDirectory
-              };
-              isCompilingCurrentFile = true;
-              ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Compiling..."));
-              ::SendMessage(nppData._nppHandle, NPPM_SAVECURRENTFILE, 0, 0);
-
-              compiler->start(activeCompilationRequest);
-            } else {
-              ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Cannot start compilation because no game is configured. Please at least enable one game in Settings dialog!"));
-            }
-          } else {
-            ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"File is not a Papyrus script processed by this lexer!"));
-          }
+  void Plugin::cancelCompilation() {
+    if (!compiler || activeCompilationRequest.bufferID == 0) {
+      ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"No active compilation"));
+      return;
+    }
+
+    // Queued requests are dropped as well, so nothing else starts once cancellation is reported.
+    queuedCompilationRequests.clear();
+    compiler->cancel();
+    ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Cancelling compilation..."));
+  }
+
+  void Plugin::inspectPexMenuFunc() {
+    papyrusPlugin.inspectPex();
+  }
+
+  void Plugin::inspectPex() {
+    wchar_t filePath[MAX_PATH];
+    if (!::SendMessage(nppData._nppHandle, NPPM_GETFULLCURRENTPATH, MAX_PATH, reinterpret_cast<LPARAM>(filePath))) {
+      return;
+    }
+
+    // A PEX file can be inspected directly, otherwise look for current script's compiled output.
+    std::filesystem::path pexPath(filePath);
+    if (!utility::endsWith(filePath, L".pex")) {
+      std::filesystem::path outputDirectory = getOutputDirectory(filePath);
+      if (outputDirectory.empty()) {
+        return;
+      }
+      std::string scriptName = Lexer::getScriptName(::SendMessage(nppData._nppHandle, NPPM_GETCURRENTBUFFERID, 0, 0));
+      if (scriptName.empty()) {
+        scriptName = pexPath.stem().string();
+      }
+      pexPath = outputDirectory / DependencyGraph::getRelativePath(scriptName, L".pex");
+    }
+
+    pex::Script script;
+    std::wstring errorMsg;
+    if (PexReader::read(pexPath.wstring(), script, errorMsg)) {
+      pexInspectorWindow->show(pexPath.wstring(), script);
+    } else {
+      ::MessageBox(nppData._nppHandle, errorMsg.c_str(), PLUGIN_NAME L" plugin", MB_ICONERROR | MB_OK);
+    }
+  }
+
+  void Plugin::compile(bool incremental) {
+    if (compiler) {
+      // Get current file path.
+      wchar_t filePath[MAX_PATH];
+      if (::SendMessage(nppData._nppHandle, NPPM_GETFULLCURRENTPATH, MAX_PATH, reinterpret_cast<LPARAM>(filePath))) {
+        CompilationRequest request;
+        std::wstring errorMsg = prepareCompilation(::SendMessage(nppData._nppHandle, NPPM_GETCURRENTBUFFERID, 0, 0), filePath, incremental, request);
+        if (errorMsg.empty()) {
+          // Active compilation of the same file already covers this request, unless file has been modified since.
+          npp_view_t currentView = static_cast<npp_view_t>(::SendMessage(nppData._nppHandle, NPPM_GETCURRENTVIEW, 0, 0));
+          HWND scintillaHandle = (currentView == MAIN_VIEW) ? nppData._scintillaMainHandle : nppData._scintillaSecondHandle;
+          bool isModified = (::SendMessage(scintillaHandle, SCI_GETMODIFY, 0, 0) != 0);
+
+          isSavingForCompilation = true;
+          ::SendMessage(nppData._nppHandle, (incremental || request.project) ? NPPM_SAVEALLFILES : NPPM_SAVECURRENTFILE, 0, 0); // Incremental and project builds check all scripts, so make sure they are all saved
+          isSavingForCompilation = false;
+
+          queueCompilation(request, isModified);
         } else {
-          std::wstring errorMsg(L"Can't start compilation due to file path exceeding ");
-          errorMsg += MAX_PATH + L" chars";
           ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(errorMsg.c_str()));
         }
       } else {
-        if (activeCompilationRequest.bufferID == ::SendMessage(nppData._nppHandle, NPPM_GETCURRENTBUFFERID, 0, 0)) {
-          ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Already compiling!"));
-        } else {
-          std::wstring errorMsg(L"Can't start compilation due to active compilation of " + activeCompilationRequest.filePath);
-          ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(errorMsg.c_str()));
-        }
+        std::wstring errorMsg(L"Can't start compilation due to file path exceeding ");
+        errorMsg += std::to_wstring(MAX_PATH) + L" chars";
+        ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(errorMsg.c_str()));
       }
     } else {
       ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Waiting for completing Papyrus settings..."));
     }
   }
 
+  std::wstring Plugin::prepareCompilation(npp_buffer_t bufferID, const std::wstring& filePath, bool incremental, CompilationRequest& request) {
+    // Papyrus projects are only supported by Fallout 4's compiler.
+    if (utility::endsWith(filePath, L".ppj")) {
+      if (!settings.compilerSettings.fo4.enabled) {
+        return L"Cannot build Papyrus project because Fallout 4 is not enabled in Settings dialog!";
+      }
+
+      request = {
+        .game = Game::Fallout4,
+        .bufferID = bufferID,
+        .filePath { filePath },
+        .project = true
+      };
+      return std::wstring();
+    }
+
+    // Check if file is handled by Papyrus Script lexer.
+    detectLangID();
+    npp_lang_type_t fileLangID = static_cast<npp_lang_type_t>(::SendMessage(nppData._nppHandle, NPPM_GETBUFFERLANGTYPE, static_cast<WPARAM>(bufferID), 0));
+
+    // Check file extension to make sure it is ".psc", and is lexed by this plugin's lexer or compiling unmanaged files is allowed.
+    if (!utility::endsWith(filePath, L".psc") || (fileLangID != scriptLangID && !settings.compilerSettings.allowUnmanagedSource)) {
+      return L"File is not a Papyrus script processed by this lexer!";
+    }
+
+    auto [detectedGame, useAutoModeOutputDirectory] = detectGameType(filePath, settings.compilerSettings);
+    if (detectedGame == Game::Auto) {
+      return L"Cannot start compilation because no game is configured. Please at least enable one game in Settings dialog!";
+    }
+
+    request = {
+      .game = detectedGame,
+      .bufferID = bufferID,
+      .filePath { filePath },
+      .useAutoModeOutputDirectory = useAutoModeOutputDirectory,
+      .incremental = incremental
+    };
+    return std::wstring();
+  }
+
+  void Plugin::queueCompilation(const CompilationRequest& request, bool restartActive) {
+    if (activeCompilationRequest.bufferID == 0) {
+      startCompilation(request);
+      return;
+    }
+
+    auto isSameFile = [&](const auto& otherRequest) { return utility::compare(otherRequest.filePath, request.filePath); };
+    bool isBatched = std::any_of(activeCompilationRequest.batchedFiles.begin(), activeCompilationRequest.batchedFiles.end(), isSameFile);
+    if ((isSameFile(activeCompilationRequest) || isBatched) && activeCompilationRequest.incremental == request.incremental) {
+      if (restartActive) {
+        // Active compilation is working on outdated content. Stop it and compile again before anything else. Restarted
+        // request covers every file batched into it, so queued requests of those files are dropped as well.
+        auto isCovered = [&](const std::wstring& filePath) {
+          return utility::compare(filePath, activeCompilationRequest.filePath) || std::any_of(activeCompilationRequest.batchedFiles.begin(), activeCompilationRequest.batchedFiles.end(),
+            [&](const auto& batchedFile) { return utility::compare(batchedFile.filePath, filePath); });
+        };
+        std::erase_if(queuedCompilationRequests, [&](const auto& queuedRequest) { return isCovered(queuedRequest.filePath); });
+        for (auto& queuedRequest : queuedCompilationRequests) {
+          std::erase_if(queuedRequest.batchedFiles, [&](const auto& batchedFile) { return isCovered(batchedFile.filePath); });
+        }
+        queuedCompilationRequests.push_front(activeCompilationRequest);
+        compiler->cancel();
+        ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Restarting compilation..."));
+      } else {
+        ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(L"Already compiling!"));
+      }
+      return;
+    }
+
+    // Merge with a queued request of the same file, otherwise queue it up.
+    auto iter = std::find_if(queuedCompilationRequests.begin(), queuedCompilationRequests.end(), isSameFile);
+    if (iter != queuedCompilationRequests.end()) {
+      iter->incremental = iter->incremental || request.incremental;
+    } else {
+      queuedCompilationRequests.push_back(request);
+    }
+
+    std::wstring msg(L"Compilation queued behind " + activeCompilationRequest.filePath + L" (" + std::to_wstring(queuedCompilationRequests.size()) + L" queued)");
+    ::SendMessage(nppData._nppHandle, NPPM_SETSTATUSBAR, STATUSBAR_DOC_TYPE, reinterpret_cast<LPARAM>(msg.c_str()));
+  }
+
+  void Plugin::compileSavedFiles() {
+    std::vector<npp_buffer_t> buffers;
+    buffers.swap(savedBuffers);
+    if (!compiler || !settings.compilerSettings.compileOnSave) {
+      return;
+    }
+
+    for (auto bufferID : buffers) {
+      std::wstring filePath = utility::getFilePathFromBuffer(nppData._nppHandle, bufferID);
+      CompilationRequest request;
+      if (!filePath.empty() && prepareCompilation(bufferID, filePath, false, request).empty()) {
+        queueCompilation(request, true); // Saved content is always newer than what active compilation is working on
+      }
+    }
+  }
+
+  void Plugin::checkSyntax(npp_buffer_t bufferID, HWND scintillaHandle) {
+    // Buffer could have been switched away from the view while waiting.
+    if (!syntaxChecker || !settings.compilerSettings.checkSyntaxInBackground || getBufferFromScintillaHandle(scintillaHandle) != bufferID) {
+      return;
+    }
+
+    if (activeSyntaxCheckRequest.bufferID != 0) {
+      pendingSyntaxCheck = std::make_pair(bufferID, scintillaHandle);
+      syntaxChecker->cancel();
+      return;
+    }
+
+    std::wstring filePath = utility::getFilePathFromBuffer(nppData._nppHandle, bufferID);
+    CompilationRequest request;
+    if (filePath.empty() || utility::endsWith(filePath, L".ppj") || !prepareCompilation(bufferID, filePath, false, request).empty()) {
+      return;
+    }
+
+    // Take a snapshot of current content, which is what the result is mapped from.
+    npp_size_t length = static_cast<npp_size_t>(::SendMessage(scintillaHandle, SCI_GETLENGTH, 0, 0));
+    const char* content = reinterpret_cast<const char*>(::SendMessage(scintillaHandle, SCI_GETCHARACTERPOINTER, 0, 0));
+    request.syntaxCheck = true;
+    request.content.assign(content, length);
+    syntaxCheckEdits.clear();
+
+    activeSyntaxCheckRequest = request;
+    syntaxChecker->start(activeSyntaxCheckRequest);
+  }
+
   void Plugin::goToMatchMenuFunc() {
     papyrusPlugin.goToMatch();
   }
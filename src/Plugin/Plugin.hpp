@@ -24,10 +24,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Common\NotepadPlusPlus.hpp"
 #include "Common\Timer.hpp"
 #include "CompilationErrorHandling\ErrorAnnotator.hpp"
+#include "CompilationErrorHandling\ErrorStore.hpp"
 #include "CompilationErrorHandling\ErrorsWindow.hpp"
 #include "Compiler\Compiler.hpp"
 #include "Compiler\CompilerSettings.hpp"
+#include "Compiler\PexInspectorWindow.hpp"
 #include "KeywordMatcher\KeywordMatcher.hpp"
+#include "LogMonitor\LogMonitor.hpp"
 #include "Settings\Settings.hpp"
 #include "Settings\SettingsDialog.hpp"
 #include "UI\AboutDialog.hpp"
@@ -35,7 +38,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "..\external\npp\PluginInterface.h"
 
+#include <deque>
+#include <filesystem>
+#include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 // Plugin constants
 //
@@ -63,6 +71,9 @@ namespace papyrus {
     private:
       enum class Menu {
         Compile,
+        IncrementalBuild,
+        CancelCompilation,
+        InspectPex,
         GoToMatch,
         Options,
         Seperator1,
@@ -76,7 +87,11 @@ namespace papyrus {
         ResetLexerStyles,
         ShowLangID,
         InstallAutoCompletion,
-        InstallFunctionList
+        InstallFunctionList,
+        AnonymizeOutputDirectory,
+        VerifyOutputDirectory,
+        ShowOutputCacheStatistics,
+        ShowCompilationTimingReport
       };
 
       void initializeComponents();
@@ -106,6 +121,9 @@ namespace papyrus {
       void onSettingsUpdated();
       void updateLexerDataGameSettings(Game game, const CompilerSettings::GameSettings& gameSettings);
 
+      // Watch Papyrus logs of enabled games if runtime log monitoring is enabled, otherwise stop watching
+      void updateLogMonitor();
+
       // Find out langID assigned to Papyrus Script lexer
       void detectLangID();
       bool checkLangName(npp_lang_type_t langID, std::wstring lexerName);
@@ -119,10 +137,49 @@ namespace papyrus {
       // Find out game type based on file path and settings
       std::pair<Game, bool> detectGameType(const std::wstring& filePath, const CompilerSettings& compilerSettings) const;
 
+      // Output directory of the game detected for a file. Empty if no game is configured, in which case user is warned
+      std::filesystem::path getOutputDirectory(const std::wstring& filePath) const;
+
       // Clear cached active compilation request, so when buffer gets switched
-      // in NPP it can be properly handled
+      // in NPP it can be properly handled. Next queued request, if any, is then started
       void clearActiveCompilation();
 
+      // Create compilation request for a file if it can be compiled. Otherwise returns an error message
+      std::wstring prepareCompilation(npp_buffer_t bufferID, const std::wstring& filePath, bool incremental, CompilationRequest& request);
+
+      // Start compilation of given request, or queue it if there is an active one. When the request is for the file being
+      // compiled, "restartActive" determines whether active compilation is cancelled and restarted, or the request is ignored
+      void queueCompilation(const CompilationRequest& request, bool restartActive);
+
+      // Start compilation of given request, which becomes the active one
+      void startCompilation(const CompilationRequest& request);
+
+      // Compile all files saved since last time, if compile-on-save is enabled
+      void compileSavedFiles();
+
+      // Check syntax of unsaved content of a buffer shown on given Scintilla view, if background syntax check is enabled.
+      // A running check is working on outdated content, so it is cancelled and the new one starts after it's done
+      void checkSyntax(npp_buffer_t bufferID, HWND scintillaHandle);
+
+      // Scripts compiled by active compilation, plus other files that earlier compilations of them reported errors against, e.g. imported
+      // scripts, or .pas files when optimize flag is set. Errors of all of these are replaced by active compilation's result
+      std::vector<std::wstring> getCompilationScopes();
+
+      // Remember files other than compiled scripts that active compilation reported errors against, so they are covered next time
+      void recordReportedFiles(const std::vector<Error>& errors);
+
+      // Clear annotated and stored errors of scripts covered by active compilation, after it succeeded
+      void clearCompiledErrors();
+
+      // Drop runtime errors of compiled scripts, which are kept until then, including those persisted by log monitor
+      void forgetRuntimeErrors(const std::vector<std::wstring>& scopes);
+
+      // Clear compilation errors from errors window, leaving runtime errors listed
+      void clearErrorsWindow();
+
+      // Status bar text of active compilation, including number of queued requests
+      std::wstring getCompilingStatus() const;
+
       // Plugin's own message handling
       static LRESULT CALLBACK messageHandleProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam);
       LRESULT handleOwnMessage(HWND window, UINT message, WPARAM wparam, LPARAM lparam);
@@ -141,9 +198,18 @@ namespace papyrus {
       void showLangID();
       void installAutoCompletion();
       void installFunctionList();
+      void anonymizeOutputDirectory();
+      void verifyOutputDirectory();
+      void showOutputCacheStatistics();
+      void showCompilationTimingReport();
 
       static void compileMenuFunc();
-      void compile();
+      static void incrementalBuildMenuFunc();
+      void compile(bool incremental = false);
+      static void cancelCompilationMenuFunc();
+      void cancelCompilation();
+      static void inspectPexMenuFunc();
+      void inspectPex();
       static void goToMatchMenuFunc();
       void goToMatch();
       static void settingsMenuFunc();
@@ -170,10 +236,25 @@ namespace papyrus {
 
       std::unique_ptr<Compiler> compiler;
       CompilationRequest activeCompilationRequest;
+      std::deque<CompilationRequest> queuedCompilationRequests;
       bool isCompilingCurrentFile {false};
+      bool isSavingForCompilation {false};
+      std::vector<npp_buffer_t> savedBuffers;
+      std::unique_ptr<utility::Timer> compileOnSaveTimer;
+      std::map<std::wstring, std::set<std::wstring>> reportedFiles; // Keyed by upper case path of compiled script
+
+      std::unique_ptr<Compiler> syntaxChecker;
+      CompilationRequest activeSyntaxCheckRequest;
+      std::pair<npp_buffer_t, HWND> pendingSyntaxCheck {0, nullptr};
+      std::vector<std::pair<int, int>> syntaxCheckEdits; // Line and number of lines added of each edit made after active check's snapshot was taken
+      std::unique_ptr<utility::Timer> syntaxCheckTimer;
 
       std::unique_ptr<ErrorsWindow> errorsWindow;
+      std::unique_ptr<PexInspectorWindow> pexInspectorWindow;
       std::unique_ptr<ErrorAnnotator> errorAnnotator;
+      ErrorStore errorStore;
+      std::unique_ptr<LogMonitor> logMonitor;
+      std::vector<Error> runtimeErrors; // Listed on errors window along with compilation errors
       std::unique_ptr<KeywordMatcher> keywordMatcher;
       std::list<Error> activatedErrorsTrackingList;
       std::unique_ptr<utility::Timer> jumpToErrorLineTimer;
@@ -81,6 +81,11 @@ namespace papyrus {
     storage.putString(L"errorAnnotator.indicatorForegroundColor" + themeSuffix, utility::colorToHexStr(errorAnnotatorSettings.indicatorForegroundColor));
 
     storage.putString(L"compiler.common.allowUnmanagedSource", utility::boolToStr(compilerSettings.allowUnmanagedSource));
+    storage.putString(L"compiler.common.compileOnSave", utility::boolToStr(compilerSettings.compileOnSave));
+    storage.putString(L"compiler.common.skipTrivialChanges", utility::boolToStr(compilerSettings.skipTrivialChanges));
+    storage.putString(L"compiler.common.checkSyntaxInBackground", utility::boolToStr(compilerSettings.checkSyntaxInBackground));
+    storage.putString(L"compiler.common.monitorRuntimeLog", utility::boolToStr(compilerSettings.monitorRuntimeLog));
+    storage.putString(L"compiler.common.outputCacheSize", std::to_wstring(compilerSettings.outputCacheSize));
     storage.putString(L"compiler.common.gameMode", game::gameNames[std::to_underlying(compilerSettings.gameMode)].first);
     storage.putString(L"compiler.auto.defaultGame", game::gameNames[std::to_underlying(compilerSettings.autoModeDefaultGame)].first);
     storage.putString(L"compiler.auto.outputDirectory", compilerSettings.autoModeOutputDirectory);
@@ -319,6 +324,45 @@ namespace papyrus {
       updated = true;
     }
 
+    if (storage.getString(L"compiler.common.compileOnSave", value)) {
+      compilerSettings.compileOnSave = utility::strToBool(value);
+    } else {
+      compilerSettings.compileOnSave = false;
+      updated = true;
+    }
+
+    if (storage.getString(L"compiler.common.skipTrivialChanges", value)) {
+      compilerSettings.skipTrivialChanges = utility::strToBool(value);
+    } else {
+      compilerSettings.skipTrivialChanges = true;
+      updated = true;
+    }
+
+    if (storage.getString(L"compiler.common.checkSyntaxInBackground", value)) {
+      compilerSettings.checkSyntaxInBackground = utility::strToBool(value);
+    } else {
+      compilerSettings.checkSyntaxInBackground = false;
+      updated = true;
+    }
+
+    if (storage.getString(L"compiler.common.monitorRuntimeLog", value)) {
+      compilerSettings.monitorRuntimeLog = utility::strToBool(value);
+    } else {
+      compilerSettings.monitorRuntimeLog = false;
+      updated = true;
+    }
+
+    if (storage.getString(L"compiler.common.outputCacheSize", value)) {
+      compilerSettings.outputCacheSize = std::stoi(value);
+      if (compilerSettings.outputCacheSize < 0) {
+        compilerSettings.outputCacheSize = DEFAULT_OUTPUT_CACHE_SIZE;
+        updated = true;
+      }
+    } else {
+      compilerSettings.outputCacheSize = DEFAULT_OUTPUT_CACHE_SIZE;
+      updated = true;
+    }
+
     if (storage.getString(L"compiler.common.gameMode", value)) {
       auto iter = game::gameAliases.find(value);
       if (iter != game::gameAliases.end()) {
@@ -582,6 +626,15 @@ namespace papyrus {
       updated = true;
     }
 
+    // Deploy directories
+    //
+    if (storage.getString(gameSettingsPrefix + L"deployDirectories", value)) {
+      gameSettings.deployDirectories = value;
+    } else {
+      gameSettings.deployDirectories.clear();
+      updated = true;
+    }
+
     // Anonynmize flag
     //
     if (storage.getString(gameSettingsPrefix + L"anonynmize", value)) {
@@ -618,6 +671,19 @@ namespace papyrus {
       updated = true;
     }
 
+    // Compilation timeout
+    //
+    if (storage.getString(gameSettingsPrefix + L"compilationTimeout", value)) {
+      gameSettings.compilationTimeout = std::stoi(value);
+      if (gameSettings.compilationTimeout < 0) {
+        gameSettings.compilationTimeout = DEFAULT_COMPILATION_TIMEOUT;
+        updated = true;
+      }
+    } else {
+      gameSettings.compilationTimeout = DEFAULT_COMPILATION_TIMEOUT;
+      updated = true;
+    }
+
     return std::make_pair(gameConfigured, updated);
   }
 
@@ -630,10 +696,12 @@ namespace papyrus {
     storage.putString(gameSettingsPrefix + L"outputDirectory", gameSettings.outputDirectory);
     storage.putString(gameSettingsPrefix + L"flagFile", gameSettings.flagFile);
     storage.putString(gameSettingsPrefix + L"additionalArguments", gameSettings.additionalArguments);
+    storage.putString(gameSettingsPrefix + L"deployDirectories", gameSettings.deployDirectories);
     storage.putString(gameSettingsPrefix + L"anonynmize", utility::boolToStr(gameSettings.anonynmizeFlag));
     storage.putString(gameSettingsPrefix + L"optimize", utility::boolToStr(gameSettings.optimizeFlag));
     storage.putString(gameSettingsPrefix + L"release", utility::boolToStr(gameSettings.releaseFlag));
     storage.putString(gameSettingsPrefix + L"final", utility::boolToStr(gameSettings.finalFlag));
+    storage.putString(gameSettingsPrefix + L"compilationTimeout", std::to_wstring(gameSettings.compilationTimeout));
   }
 
 } // namespace
@@ -213,6 +213,11 @@ namespace papyrus {
         enableGroup(Group::GameFO4, settings.compilerSettings.fo4.enabled);
 
         setChecked(tab, IDC_SETTINGS_COMPILER_ALLOW_UNMANAGED_SOURCE, settings.compilerSettings.allowUnmanagedSource);
+        setChecked(tab, IDC_SETTINGS_COMPILER_COMPILE_ON_SAVE, settings.compilerSettings.compileOnSave);
+        setChecked(tab, IDC_SETTINGS_COMPILER_SKIP_TRIVIAL_CHANGES, settings.compilerSettings.skipTrivialChanges);
+        setChecked(tab, IDC_SETTINGS_COMPILER_CHECK_SYNTAX_IN_BACKGROUND, settings.compilerSettings.checkSyntaxInBackground);
+        setChecked(tab, IDC_SETTINGS_COMPILER_MONITOR_RUNTIME_LOG, settings.compilerSettings.monitorRuntimeLog);
+        setText(tab, IDC_SETTINGS_COMPILER_OUTPUT_CACHE_SIZE, std::to_wstring(settings.compilerSettings.outputCacheSize));
         setChecked(tab, IDC_SETTINGS_COMPILER_RADIO_AUTO + std::to_underlying(settings.compilerSettings.gameMode), true);
         setText(tab, IDC_SETTINGS_COMPILER_AUTO_DEFAULT_OUTPUT, settings.compilerSettings.autoModeOutputDirectory);
         updateAutoModeDefaultGame();
@@ -234,8 +239,10 @@ namespace papyrus {
           setText(tab, IDC_SETTINGS_TAB_GAME_COMPILER_PATH, gameSettings.compilerPath);
           setText(tab, IDC_SETTINGS_TAB_GAME_OUTPUT_DIRECTORY, gameSettings.outputDirectory);
           setText(tab, IDC_SETTINGS_TAB_GAME_FLAG_FILE, gameSettings.flagFile);
+          setText(tab, IDC_SETTINGS_TAB_GAME_DEPLOY_DIRECTORIES, gameSettings.deployDirectories);
           setChecked(tab, IDC_SETTINGS_TAB_GAME_ANONYMIZE, gameSettings.anonynmizeFlag);
           setChecked(tab, IDC_SETTINGS_TAB_GAME_OPTIMIZE, gameSettings.optimizeFlag);
+          setText(tab, IDC_SETTINGS_TAB_GAME_COMPILATION_TIMEOUT, std::to_wstring(gameSettings.compilationTimeout));
           if (game == Game::Fallout4) {
             setChecked(tab, IDC_SETTINGS_TAB_GAME_RELEASE, gameSettings.releaseFlag);
             setChecked(tab, IDC_SETTINGS_TAB_GAME_FINAL, gameSettings.finalFlag);
@@ -666,11 +673,22 @@ namespace papyrus {
     setText(tab, controlID, enabled ? L"Disable" : L"Enable");
   }
 
-  void SettingsDialog::saveGameSettings(tab_id_t tab, CompilerSettings::GameSettings& gameSettings) const {
+  bool SettingsDialog::saveGameSettings(tab_id_t tab, CompilerSettings::GameSettings& gameSettings) const {
+    std::wstring compilationTimeoutStr = getText(tab, IDC_SETTINGS_TAB_GAME_COMPILATION_TIMEOUT);
+    if (!utility::isNumber(compilationTimeoutStr) || compilationTimeoutStr.length() > 5) {
+      ::MessageBox(getHSelf(), L"Compilation timeout needs to be a number between 0 and 99999 (in second)", L"Invalid setting", MB_ICONERROR | MB_OK);
+      return false;
+    }
+
+    int compilationTimeout {};
+    std::wistringstream(compilationTimeoutStr) >> compilationTimeout;
+    gameSettings.compilationTimeout = compilationTimeout;
+
     gameSettings.installPath = getText(tab, IDC_SETTINGS_TAB_GAME_INSTALL_PATH);
     gameSettings.compilerPath = getText(tab, IDC_SETTINGS_TAB_GAME_COMPILER_PATH);
     gameSettings.outputDirectory = getText(tab, IDC_SETTINGS_TAB_GAME_OUTPUT_DIRECTORY);
     gameSettings.flagFile = getText(tab, IDC_SETTINGS_TAB_GAME_FLAG_FILE);
+    gameSettings.deployDirectories = getText(tab, IDC_SETTINGS_TAB_GAME_DEPLOY_DIRECTORIES);
     gameSettings.anonynmizeFlag = getChecked(tab, IDC_SETTINGS_TAB_GAME_ANONYMIZE);
     gameSettings.optimizeFlag = getChecked(tab, IDC_SETTINGS_TAB_GAME_OPTIMIZE);
     if (getGame(tab) == Game::Fallout4) {
@@ -689,6 +707,7 @@ namespace papyrus {
     if (!gameSettings.importDirectories.empty() && gameSettings.importDirectories.back() == L';') {
       gameSettings.importDirectories = gameSettings.importDirectories.substr(0, gameSettings.importDirectories.find_last_not_of(L';') + 1);
     }
+    return true;
   }
 
   bool SettingsDialog::saveSettings() {
@@ -757,12 +776,26 @@ namespace papyrus {
 
     constexpr tab_id_t compilerTab = std::to_underlying(Tab::Compiler);
     if (isTabDialogCreated(compilerTab)) {
+      std::wstring outputCacheSizeStr = getText(compilerTab, IDC_SETTINGS_COMPILER_OUTPUT_CACHE_SIZE);
+      if (!utility::isNumber(outputCacheSizeStr) || outputCacheSizeStr.length() > 6) {
+        ::MessageBox(getHSelf(), L"Compiled output cache size needs to be a number between 0 and 999999 (in MiB)", L"Invalid setting", MB_ICONERROR | MB_OK);
+        return false;
+      }
+
+      int outputCacheSize {};
+      std::wistringstream(outputCacheSizeStr) >> outputCacheSize;
+
       settings.compilerSettings.gameMode =
         getChecked(compilerTab, IDC_SETTINGS_COMPILER_RADIO_SKYRIM) ? Game::Skyrim :
         getChecked(compilerTab, IDC_SETTINGS_COMPILER_RADIO_SSE) ? Game::SkyrimSE :
         getChecked(compilerTab, IDC_SETTINGS_COMPILER_RADIO_FO4) ? Game::Fallout4 :
         Game::Auto;
       settings.compilerSettings.allowUnmanagedSource = getChecked(compilerTab, IDC_SETTINGS_COMPILER_ALLOW_UNMANAGED_SOURCE);
+      settings.compilerSettings.compileOnSave = getChecked(compilerTab, IDC_SETTINGS_COMPILER_COMPILE_ON_SAVE);
+      settings.compilerSettings.skipTrivialChanges = getChecked(compilerTab, IDC_SETTINGS_COMPILER_SKIP_TRIVIAL_CHANGES);
+      settings.compilerSettings.checkSyntaxInBackground = getChecked(compilerTab, IDC_SETTINGS_COMPILER_CHECK_SYNTAX_IN_BACKGROUND);
+      settings.compilerSettings.monitorRuntimeLog = getChecked(compilerTab, IDC_SETTINGS_COMPILER_MONITOR_RUNTIME_LOG);
+      settings.compilerSettings.outputCacheSize = outputCacheSize;
       settings.compilerSettings.autoModeOutputDirectory = getText(compilerTab, IDC_SETTINGS_COMPILER_AUTO_DEFAULT_OUTPUT);
       settings.compilerSettings.autoModeDefaultGame = game::games[getText(compilerTab, IDC_SETTINGS_COMPILER_AUTO_DEFAULT_GAME_DROPDOWN)];
     }
@@ -771,7 +804,9 @@ namespace papyrus {
       Game game = static_cast<Game>(i);
       tab_id_t gameTab = getGameTab(game);
       if (gameTab > std::to_underlying(Tab::GameBase) && isTabDialogCreated(gameTab)) {
-        saveGameSettings(gameTab, settings.compilerSettings.gameSettings(game));
+        if (!saveGameSettings(gameTab, settings.compilerSettings.gameSettings(game))) {
+          return false;
+        }
       }
     }
 
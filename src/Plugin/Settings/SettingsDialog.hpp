@@ -86,7 +86,7 @@ namespace papyrus {
       void updateAutoModeDefaultGame() const;
       void updateGameEnableButtonText(int controlID, bool enabled) const;
 
-      void saveGameSettings(tab_id_t tab, CompilerSettings::GameSettings& gameSettings) const;
+      bool saveGameSettings(tab_id_t tab, CompilerSettings::GameSettings& gameSettings) const;
       bool saveSettings();
 
       // Private members
@@ -0,0 +1,101 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Benchmark of compiling scripts of a folder one by one versus in one batched compiler run ("-all"), the way
+// Compiler::runBatch() does, using the stub compiler in place of PapyrusCompiler:
+//   BatchBenchmark <stub compiler path> [-scripts=<count>] [-startup=<ms>] [-errors=<count>]
+// -scripts is the number of scripts in the folder (default 20), -startup is stub compiler's startup time in milliseconds
+// (default 0; the real compiler takes a few hundred), and -errors is the number of errors each run reports (default 0).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace {
+
+#ifdef _WIN32
+  constexpr const char* NULL_DEVICE = "NUL";
+#else
+  constexpr const char* NULL_DEVICE = "/dev/null";
+#endif
+
+  bool parseOption(std::string_view arg, std::string_view name, long long& value) {
+    if (!arg.starts_with(name) || arg.size() <= name.size() || arg[name.size()] != '=') {
+      return false;
+    }
+    value = std::atoll(std::string(arg.substr(name.size() + 1)).c_str());
+    return true;
+  }
+
+  // Run the compiler with given arguments, returning seconds taken
+  double run(const std::string& compilerPath, const std::string& arguments) {
+    std::string command = "\"" + compilerPath + "\" " + arguments + " >" + NULL_DEVICE + " 2>&1";
+#ifdef _WIN32
+    command = "\"" + command + "\""; // cmd strips the outer quotes
+#endif
+    auto startTime = std::chrono::steady_clock::now();
+    std::system(command.c_str());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::printf("Usage: BatchBenchmark <stub compiler path> [-scripts=<count>] [-startup=<ms>] [-errors=<count>]\n");
+    return 2;
+  }
+  std::string compilerPath = argv[1];
+  long long scriptCount = 20;
+  long long startupTime = 0;
+  long long errorCount = 0;
+  for (int i = 2; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (!parseOption(arg, "-scripts", scriptCount) && !parseOption(arg, "-startup", startupTime) && !parseOption(arg, "-errors", errorCount)) {
+      std::printf("Unknown option: %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if (scriptCount < 1) {
+    scriptCount = 1;
+  }
+
+  std::string options = " -i=\"Source\" -o=\"Output\" -f=\"Flags.flg\" -startup=" + std::to_string(startupTime) + " -errors=" + std::to_string(errorCount);
+  double perFileTime = 0;
+  for (long long i = 0; i < scriptCount; ++i) {
+    perFileTime += run(compilerPath, "\"Source/Script" + std::to_string(i) + ".psc\"" + options);
+  }
+  double batchedTime = run(compilerPath, "\"Source\" -all" + options);
+
+  std::printf("%lld scripts, %lld ms startup, %lld errors per run\n", scriptCount, startupTime, errorCount);
+  std::printf("  per file: %9.1f ms (%lld compiler runs)\n", perFileTime * 1000, scriptCount);
+  std::printf("  batched:  %9.1f ms (1 compiler run)\n", batchedTime * 1000);
+  std::printf("  speedup:  %9.1fx\n", batchedTime > 0 ? perFileTime / batchedTime : 0.0);
+
+  // With more than a couple of scripts, saved compiler startups outweigh any noise.
+  if (scriptCount >= 5 && batchedTime >= perFileTime) {
+    std::printf("FAILED: batched run is not faster than compiling one by one\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Standalone test of compiler error parsing, which doesn't depend on Win32 or Notepad++.
+
+#include "../src/Plugin/CompilationErrorHandling/CompilerErrorParser.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace papyrus;
+
+namespace {
+
+  int failures = 0;
+
+  void check(bool condition, const char* what) {
+    if (!condition) {
+      failures++;
+      std::printf("FAILED: %s\n", what);
+    }
+  }
+
+  bool isError(const Error& error, const std::wstring& file, int line, int column, const std::wstring& message) {
+    return error.file == file && error.line == line && error.column == column && error.message == message;
+  }
+
+  void testScriptErrors() {
+    std::vector<Error> errors;
+    bool hasUnparsableLines = CompilerErrorParser::parse(
+      L"C:\\Mods (Old)\\Source\\A.psc(3,5): variable x is undefined\r\n"
+      L"C:\\Source\\B.psc(7): script B is not flagged as conditional\r\n"
+      L"<unknown>(0,0): unable to locate script C\r\n"
+      L"Compilation failed.\r\n",
+      false, L"C:\\Output", errors);
+    check(!hasUnparsableLines, "lines without a script are skipped, not unparsable");
+    check(errors.size() == 3, "script errors are parsed");
+    if (errors.size() == 3) {
+      check(isError(errors[0], L"C:\\Mods (Old)\\Source\\A.psc", 3, 5, L"variable x is undefined"), "path containing parenthesis");
+      check(isError(errors[1], L"C:\\Source\\B.psc", 7, 0, L"script B is not flagged as conditional"), "error without column");
+      check(isError(errors[2], L"<unknown>", 0, 0, L"unable to locate script C"), "error of unknown file");
+    }
+  }
+
+  void testDuplicates() {
+    std::vector<Error> errors;
+    CompilerErrorParser::parse(
+      L"C:\\Source\\A.psc(3,5): duplicated\n"
+      L"C:\\Source\\A.psc(3,5): duplicated\n"
+      L"C:\\Source\\A.psc(3,6): duplicated\n"
+      L"C:\\Source\\A.psc(3,5): other\n",
+      false, L"C:\\Output", errors);
+    check(errors.size() == 3, "duplicate errors are discarded");
+  }
+
+  void testAssemblyErrors() {
+    std::wstring output = L"A.pas(12):  unknown opcode\r\nB.pas(x):  not a line\r\n";
+
+    std::vector<Error> errors;
+    CompilerErrorParser::parse(output, false, L"C:\\Output", errors);
+    check(errors.size() == 1 && errors[0].file.empty() && errors[0].message == output, ".pas errors are only parsed with optimize flag");
+
+    errors.clear();
+    bool hasUnparsableLines = CompilerErrorParser::parse(output, true, L"C:\\Output", errors);
+    check(hasUnparsableLines, "malformed .pas error is unparsable");
+    check(errors.size() == 1 && isError(errors[0], (std::filesystem::path(L"C:\\Output") / L"A.pas").wstring(), 12, 1, L"unknown opcode"),
+      ".pas error is put under output directory");
+  }
+
+  void testUnparsable() {
+    std::vector<Error> errors;
+    bool hasUnparsableLines = CompilerErrorParser::parse(L"C:\\Source\\A.psc(x,1): bad line\n", false, L"C:\\Output", errors);
+    check(hasUnparsableLines, "malformed script error is unparsable");
+    check(errors.size() == 1 && errors[0].file.empty(), "whole output is kept when nothing is parsed");
+  }
+
+  // Parse the given number of distinct error lines, returning seconds taken
+  double timeParse(size_t lineCount) {
+    std::wstring output;
+    for (size_t i = 0; i < lineCount; ++i) {
+      output += L"C:\\Source\\Script" + std::to_wstring(i % 100) + L".psc(" + std::to_wstring(i) + L",1): variable is undefined\r\n";
+    }
+
+    std::vector<Error> errors;
+    auto startTime = std::chrono::steady_clock::now();
+    CompilerErrorParser::parse(output, false, L"C:\\Output", errors);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    check(errors.size() == lineCount, "all generated errors are parsed");
+    return elapsed.count();
+  }
+
+  void testScaling() {
+    double smallTime = timeParse(10000);
+    double largeTime = timeParse(100000);
+    std::printf("Parsed 10k lines in %.1f ms, 100k lines in %.1f ms\n", smallTime * 1000, largeTime * 1000);
+
+    // Ten times the lines should take about ten times as long; allow generous noise but catch quadratic growth.
+    check(largeTime < smallTime * 30 + 0.05, "parsing time grows linearly with line count");
+  }
+
+} // namespace
+
+int main() {
+  testScriptErrors();
+  testDuplicates();
+  testAssemblyErrors();
+  testUnparsable();
+  testScaling();
+  if (failures > 0) {
+    std::printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}
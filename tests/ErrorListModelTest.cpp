@@ -0,0 +1,173 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Standalone test of errors window's list model, which doesn't depend on Win32 or Notepad++.
+
+#include "../src/Plugin/CompilationErrorHandling/ErrorListModel.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace papyrus;
+
+namespace {
+
+  int failures = 0;
+
+  // Messages of shown rows in display order
+  std::vector<std::wstring> messages(const ErrorListModel& model) {
+    std::vector<std::wstring> result;
+    for (size_t row = 0; row < model.size(); ++row) {
+      result.push_back(model.error(row).message);
+    }
+    return result;
+  }
+
+  void expect(const ErrorListModel& model, const std::vector<std::wstring>& expected, const char* what) {
+    auto actual = messages(model);
+    if (actual != expected) {
+      failures++;
+      std::printf("FAILED: %s\n  expected:", what);
+      for (const auto& message : expected) {
+        std::printf(" %ls", message.c_str());
+      }
+      std::printf("\n  actual:  ");
+      for (const auto& message : actual) {
+        std::printf(" %ls", message.c_str());
+      }
+      std::printf("\n");
+    }
+  }
+
+  void testAppendMerge() {
+    ErrorListModel model;
+    model.append({
+      { .file = L"C:\\Source\\B.psc", .message = L"b5", .line = 5, .column = 1 },
+      { .file = L"C:\\Source\\A.psc", .message = L"a9", .line = 9, .column = 1 },
+      { .file = L"C:\\Source\\B.psc", .message = L"b2", .line = 2, .column = 1 }
+    });
+    expect(model, { L"a9", L"b2", L"b5" }, "append sorts by file, then line");
+
+    // Appended errors are merged into every sort order, including ones interleaving with existing errors.
+    model.append({
+      { .file = L"C:\\Source\\A.psc", .message = L"a1", .line = 1, .column = 1 },
+      { .file = L"C:\\Source\\C.psc", .message = L"c3", .line = 3, .column = 1 },
+      { .file = L"C:\\Source\\B.psc", .message = L"b2", .line = 2, .column = 7 }
+    });
+    expect(model, { L"a1", L"a9", L"b2", L"b2", L"b5", L"c3" }, "append merges into file order");
+    if (model.error(2).column != 1 || model.error(3).column != 7) {
+      failures++;
+      std::printf("FAILED: errors on the same line are ordered by column\n");
+    }
+
+    model.sort(ErrorListModel::SortKey::Line, true);
+    expect(model, { L"a1", L"b2", L"b2", L"c3", L"b5", L"a9" }, "appended errors are merged into line order");
+    model.sort(ErrorListModel::SortKey::Message, true);
+    expect(model, { L"a1", L"a9", L"b2", L"b2", L"b5", L"c3" }, "appended errors are merged into message order");
+
+    model.clear();
+    expect(model, {}, "clear removes all rows");
+  }
+
+  void testFilter() {
+    ErrorListModel model;
+    model.append({
+      { .file = L"C:\\Source\\Quest.psc", .message = L"variable Foo is undefined", .line = 1 },
+      { .file = L"C:\\Source\\Quest.psc", .message = L"type mismatch", .line = 2 },
+      { .file = L"C:\\Source\\Actor.psc", .message = L"variable Bar is undefined", .line = 3 },
+      { .file = L"C:\\Source\\Actor.psc", .message = L"missing return", .line = 4 }
+    });
+
+    // Narrowing only rechecks rows that still match, and is case-insensitive.
+    model.filter(L"", L"VAR");
+    expect(model, { L"variable Bar is undefined", L"variable Foo is undefined" }, "text filter");
+    model.filter(L"", L"variable foo");
+    expect(model, { L"variable Foo is undefined" }, "narrowing text filter");
+
+    // Widening only rechecks rows that were filtered out.
+    model.filter(L"", L"var");
+    expect(model, { L"variable Bar is undefined", L"variable Foo is undefined" }, "widening text filter");
+
+    model.filter(L"quest", L"var");
+    expect(model, { L"variable Foo is undefined" }, "file and text filters combined");
+    model.filter(L"quest", L"");
+    expect(model, { L"variable Foo is undefined", L"type mismatch" }, "clearing text filter keeps file filter");
+
+    // Filter that neither narrows nor widens the previous one.
+    model.filter(L"actor", L"");
+    expect(model, { L"variable Bar is undefined", L"missing return" }, "replacing file filter");
+
+    // Appended errors are filtered as well.
+    model.append({
+      { .file = L"C:\\Source\\Actor.psc", .message = L"unknown function", .line = 0 },
+      { .file = L"C:\\Source\\Other.psc", .message = L"unknown function", .line = 0 }
+    });
+    expect(model, { L"unknown function", L"variable Bar is undefined", L"missing return" }, "appending with filter");
+
+    model.filter(L"", L"");
+    if (model.size() != 6) {
+      failures++;
+      std::printf("FAILED: clearing filters shows all rows, got %zu\n", model.size());
+    }
+  }
+
+  void testSortDirection() {
+    ErrorListModel model;
+    model.append({
+      { .file = L"C:\\Source\\A.psc", .message = L"m2", .line = 3 },
+      { .file = L"C:\\Source\\B.psc", .message = L"m3", .line = 1 },
+      { .file = L"C:\\Source\\C.psc", .message = L"m1", .line = 2 }
+    });
+
+    model.sort(ErrorListModel::SortKey::Line, true);
+    expect(model, { L"m3", L"m1", L"m2" }, "ascending line order");
+    model.sort(ErrorListModel::SortKey::Line, false);
+    expect(model, { L"m2", L"m1", L"m3" }, "descending line order");
+    if (model.sortKey() != ErrorListModel::SortKey::Line || model.isAscending()) {
+      failures++;
+      std::printf("FAILED: sort key and direction are kept\n");
+    }
+
+    // Direction applies to filtered rows and to appended errors.
+    model.filter(L"", L"m");
+    model.append({ { .file = L"C:\\Source\\D.psc", .message = L"m0", .line = 0 } });
+    expect(model, { L"m2", L"m1", L"m3", L"m0" }, "descending order with appended error");
+    model.filter(L"", L"m1");
+    expect(model, { L"m1" }, "descending order with filter");
+    model.filter(L"", L"");
+    model.sort(ErrorListModel::SortKey::Message, false);
+    expect(model, { L"m3", L"m2", L"m1", L"m0" }, "descending message order");
+    model.sort(ErrorListModel::SortKey::Message, true);
+    expect(model, { L"m0", L"m1", L"m2", L"m3" }, "toggled back to ascending");
+  }
+
+} // namespace
+
+int main() {
+  testAppendMerge();
+  testFilter();
+  testSortDirection();
+  if (failures > 0) {
+    std::printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Benchmark of the compile path over error volume: launches the stub compiler, captures its output and parses errors
+// with CompilerErrorParser, the way Compiler::runCompiler() does, for 0, 1, 10, ... errors up to the given maximum:
+//   ErrorVolumeBenchmark <stub compiler path> [-max=<count>] [-stdout]
+// -max is the largest error count (default 1000000), and -stdout has errors reported on stdout instead of stderr.
+// Peak memory is that of this process, which holds captured output and parsed errors the same way the plugin does.
+// It's the highest so far, which is the current run's as the sweep goes up. Compiler's own peak memory isn't
+// included, as a forked child counts its parent's memory too.
+// Plugin's own pipe reading and annotation are Win32 bound and not included; use the stub compiler as a game's
+// compiler and the compilation timing report for those.
+
+#include "../src/Plugin/CompilationErrorHandling/CompilerErrorParser.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace papyrus;
+
+namespace {
+
+  // Peak resident memory in MiB of this process, or -1 if not available
+  double peakMemory() {
+#ifdef _WIN32
+    return -1;
+#else
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+  }
+
+  // Run the command and return its output
+  std::string capture(const std::string& command) {
+#ifdef _WIN32
+    FILE* pipe = _popen(("\"" + command + "\"").c_str(), "rb"); // cmd strips the outer quotes
+#else
+    FILE* pipe = popen(command.c_str(), "r");
+#endif
+    std::string output;
+    if (pipe == nullptr) {
+      return output;
+    }
+    char buffer[64 * 1024];
+    size_t readSize;
+    while ((readSize = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+      output.append(buffer, readSize);
+    }
+#ifdef _WIN32
+    _pclose(pipe);
+#else
+    pclose(pipe);
+#endif
+    return output;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::printf("Usage: ErrorVolumeBenchmark <stub compiler path> [-max=<count>] [-stdout]\n");
+    return 2;
+  }
+  std::string compilerPath = argv[1];
+  long long maxErrorCount = 1000000;
+  bool useStdout = false;
+  for (int i = 2; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (arg.starts_with("-max=")) {
+      maxErrorCount = std::atoll(argv[i] + 5);
+    } else if (arg == "-stdout") {
+      useStdout = true;
+    } else {
+      std::printf("Unknown option: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  std::printf("%10s %10s %10s %10s %12s %10s\n", "errors", "wall ms", "parse ms", "peak MiB", "errors/s", "MiB/s");
+  bool succeeded = true;
+  for (long long errorCount = 0; errorCount <= maxErrorCount; errorCount = errorCount == 0 ? 1 : errorCount * 10) {
+    std::string command = "\"" + compilerPath + "\" Source/Test.psc -i=Source -o=Output -errors=" + std::to_string(errorCount)
+      + (useStdout ? " -stdout 2>&1" : " 2>&1");
+    auto startTime = std::chrono::steady_clock::now();
+    std::string output = capture(command);
+    auto parseStartTime = std::chrono::steady_clock::now();
+
+    // Compiler output is ASCII, so widening each character is the same as decoding it.
+    std::wstring errorText(output.begin(), output.end());
+    std::vector<Error> errors;
+    CompilerErrorParser::parse(errorText, false, L"Output", errors);
+    auto endTime = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> wallTime = endTime - startTime;
+    std::chrono::duration<double> parseTime = endTime - parseStartTime;
+    std::printf("%10lld %10.1f %10.1f %10.1f %12.0f %10.1f\n", errorCount, wallTime.count() * 1000, parseTime.count() * 1000,
+      peakMemory(), errorCount / wallTime.count(), output.size() / (1024.0 * 1024.0) / wallTime.count());
+
+    // Without errors, the whole (empty) output is reported as one error.
+    size_t expectedCount = errorCount > 0 ? static_cast<size_t>(errorCount) : 1;
+    if (errors.size() != expectedCount) {
+      std::printf("FAILED: %zu errors parsed, expected %zu\n", errors.size(), expectedCount);
+      succeeded = false;
+    }
+  }
+  return succeeded ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+/*
+This file is part of Papyrus Plugin for Notepad++.
+
+Copyright (C) 2021 blu3mania <blu3mania@hotmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Stand-in for PapyrusCompiler that prints a chosen number of errors, to benchmark the plugin's compile path from process
+// launch through output capture, error parsing and annotation, independent of how fast the real compiler is.
+//
+// Set it as a game's compiler path, and pass its options with the game's additional compiler arguments:
+//   -errors=<count>    number of errors to print, default 0
+//   -size=<bytes>      length of each error message, default 40
+//   -rate=<count>      errors printed per second, default 0 for as fast as possible
+//   -stdout            print errors on stdout after "compilation failed", the way compiler reports .pas errors, instead of stderr
+//   -exit=<code>       exit code, default 1 if there are errors, otherwise 0
+//   -startup=<ms>      time spent before compiling, to mimic compiler's startup cost, default 0
+// All other arguments are those passed to the real compiler. The first one that is not an option is the compiled target,
+// which errors are reported on.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+  bool parseOption(std::string_view arg, std::string_view name, long long& value) {
+    if (!arg.starts_with(name) || arg.size() <= name.size() || arg[name.size()] != '=') {
+      return false;
+    }
+    value = std::atoll(std::string(arg.substr(name.size() + 1)).c_str());
+    return true;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  long long errorCount = 0;
+  long long messageSize = 40;
+  long long rate = 0;
+  long long exitCode = -1;
+  long long startupTime = 0;
+  bool useStdout = false;
+  std::string target = "Stub.psc";
+  bool hasTarget = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg(argv[i]);
+    if (parseOption(arg, "-errors", errorCount) || parseOption(arg, "-size", messageSize) || parseOption(arg, "-rate", rate) || parseOption(arg, "-exit", exitCode)
+      || parseOption(arg, "-startup", startupTime)) {
+      continue;
+    }
+    if (arg == "-stdout") {
+      useStdout = true;
+    } else if (!hasTarget && !arg.starts_with("-")) {
+      target = arg;
+      hasTarget = true;
+    }
+  }
+
+  // Folder target compiled with "-all" reports errors on a script in it.
+  if (!target.ends_with(".psc")) {
+    target += "\\Stub.psc";
+  }
+
+  if (startupTime > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(startupTime));
+  }
+
+  FILE* stream = useStdout ? stdout : stderr;
+  static char buffer[1 << 16];
+  std::setvbuf(stream, buffer, _IOFBF, sizeof(buffer));
+  if (useStdout && errorCount > 0) {
+    std::fputs("Starting 1 compile threads for 1 files...\ncompilation failed\n", stream);
+  }
+
+  // Each error is on its own line, so none of them is deduplicated by the plugin.
+  std::string message(static_cast<size_t>(messageSize > 0 ? messageSize : 0), 'x');
+  auto startTime = std::chrono::steady_clock::now();
+  for (long long i = 0; i < errorCount; ++i) {
+    if (rate > 0 && i % rate == 0 && i > 0) {
+      std::fflush(stream);
+      std::this_thread::sleep_until(startTime + std::chrono::seconds(i / rate));
+    }
+    std::fprintf(stream, "%s(%lld,1): %s\n", target.c_str(), i + 1, message.c_str());
+  }
+  std::fflush(stream);
+
+  return static_cast<int>(exitCode >= 0 ? exitCode : (errorCount > 0 ? 1 : 0));
+}